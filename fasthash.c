@@ -24,6 +24,28 @@
 */
 
 #include "fasthash.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/random.h>
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define FASTHASH_X86 1
+// GCC 12 flags _mm512_undefined_epi32() inside its own headers; the
+// warning is reported at the header lines, so only they are exempt
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
 
 // Compression function for Merkle-Damgard construction.
 // This function is generated using the framework provided.
@@ -34,11 +56,46 @@
     (h) ^= (h) >> 47;                                                          \
   })
 
-uint64_t fasthash64(const void *buf, size_t len, uint64_t seed) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define le64(x) __builtin_bswap64(x)
+#define le32(x) __builtin_bswap32(x)
+#else
+#define le64(x) (x)
+#define le32(x) (x)
+#endif
+
+// Gathers the n = 1..7 trailing bytes at pos2 into a little-endian
+// word. Only those n bytes are read: two overlapping 32-bit loads for
+// n >= 4, three possibly repeated byte loads otherwise. This replaces
+// a switch on n, which mispredicts when key lengths vary.
+static inline uint64_t load_tail(const unsigned char *pos2, size_t n) {
+  uint32_t lo, hi;
+
+  if (n >= 4) {
+    memcpy(&lo, pos2, 4);
+    memcpy(&hi, pos2 + n - 4, 4);
+    return le32(lo) | (uint64_t)le32(hi) << (8 * (n - 4));
+  }
+
+  return (uint64_t)pos2[0] | (uint64_t)pos2[n / 2] << (8 * (n / 2)) |
+         (uint64_t)pos2[n - 1] << (8 * (n - 1));
+}
+
+// Same as load_tail(), for when the 8 - n bytes before pos2 belong to
+// the key as well: one 8-byte load that ends at the last byte.
+static inline uint64_t load_tail_behind(const unsigned char *pos2, size_t n) {
+  uint64_t v;
+
+  memcpy(&v, pos2 + n - 8, 8);
+  return le64(v) >> (64 - 8 * n);
+}
+
+// The fasthash64 chain over a whole key, without the final mix.
+static inline uint64_t fasthash64_chain(const void *buf, size_t len,
+                                        uint64_t seed) {
   const uint64_t m = 0x880355f21e6d1965ULL;
   const uint64_t *pos = (const uint64_t *)buf;
   const uint64_t *end = pos + (len / 8);
-  const unsigned char *pos2;
   uint64_t h = seed ^ (len * m);
   uint64_t v;
 
@@ -48,24 +105,79 @@ uint64_t fasthash64(const void *buf, size_t len, uint64_t seed) {
     h *= m;
   }
 
-  pos2 = (const unsigned char *)pos;
-  v = 0;
-
-  switch (len & 7) {
-  case 7:
-    v ^= (uint64_t)pos2[6] << 48; /* fallthrough */
-  case 6:
-    v ^= (uint64_t)pos2[5] << 40; /* fallthrough */
-  case 5:
-    v ^= (uint64_t)pos2[4] << 32; /* fallthrough */
-  case 4:
-    v ^= (uint64_t)pos2[3] << 24; /* fallthrough */
-  case 3:
-    v ^= (uint64_t)pos2[2] << 16; /* fallthrough */
-  case 2:
-    v ^= (uint64_t)pos2[1] << 8;  /* fallthrough */
-  case 1:
-    v ^= (uint64_t)pos2[0];
+  if (len & 7) {
+    if (len >= 8)
+      v = load_tail_behind((const unsigned char *)pos, len & 7);
+    else
+      v = load_tail((const unsigned char *)pos, len & 7);
+    h ^= mix(v);
+    h *= m;
+  }
+
+  return h;
+}
+
+uint64_t fasthash64(const void *buf, size_t len, uint64_t seed) {
+  uint64_t h = fasthash64_chain(buf, len, seed);
+  return mix(h);
+}
+
+// Two chains with different multipliers, the two of SplitMix64's
+// finalizer, share the mixed input word, which is cheaper than two
+// fasthash64() calls.
+void fasthash128(const void *buf, size_t len, uint64_t seed, uint64_t out[2]) {
+  const uint64_t m1 = 0xbf58476d1ce4e5b9ULL;
+  const uint64_t m2 = 0x94d049bb133111ebULL;
+  const unsigned char *pos = (const unsigned char *)buf;
+  const unsigned char *end = pos + (len & ~(size_t)7);
+  uint64_t h1 = seed ^ (len * m1);
+  uint64_t h2 = seed ^ (len * m2);
+  uint64_t v;
+
+  for (; pos != end; pos += 8) {
+    memcpy(&v, pos, 8);
+    mix(v);
+    h1 ^= v;
+    h1 *= m1;
+    h2 ^= v;
+    h2 *= m2;
+  }
+
+  if (len & 7) {
+    if (len >= 8)
+      v = load_tail_behind(pos, len & 7);
+    else
+      v = load_tail(pos, len & 7);
+    mix(v);
+    h1 ^= v;
+    h1 *= m1;
+    h2 ^= v;
+    h2 *= m2;
+  }
+
+  // cross the chains so each output word depends on both
+  h1 += h2;
+  h2 ^= h1 >> 29;
+  out[0] = mix(h1);
+  out[1] = mix(h2);
+}
+
+// Continues a fasthash64 chain h over the rest of a key.
+static inline uint64_t fasthash64_finish(const unsigned char *pos,
+                                         size_t len, uint64_t h) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  uint64_t v;
+
+  while (len >= 8) {
+    memcpy(&v, pos, 8);
+    h ^= mix(v);
+    h *= m;
+    pos += 8;
+    len -= 8;
+  }
+
+  if (len) {
+    v = load_tail(pos, len);
     h ^= mix(v);
     h *= m;
   }
@@ -73,6 +185,555 @@ uint64_t fasthash64(const void *buf, size_t len, uint64_t seed) {
   return mix(h);
 }
 
+// Four independent lanes absorb 32-byte stripes, so the multiplies of
+// consecutive words no longer wait on each other. The lanes are folded
+// in order into one chain, which then absorbs the remaining bytes like
+// fasthash64(). Inputs shorter than one stripe hash exactly like
+// fasthash64(). The output is frozen, see test_fasthash.
+uint64_t fasthash64_wide(const void *buf, size_t len, uint64_t seed) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  const unsigned char *pos = (const unsigned char *)buf;
+  uint64_t h = seed ^ (len * m);
+  uint64_t v0, v1, v2, v3;
+
+  if (len >= 32) {
+    uint64_t h0 = h;
+    uint64_t h1 = h ^ m;
+    uint64_t h2 = h ^ (2 * m);
+    uint64_t h3 = h ^ (3 * m);
+    size_t rest = len & 31;
+
+    for (len -= rest; len; len -= 32, pos += 32) {
+      memcpy(&v0, pos, 8);
+      memcpy(&v1, pos + 8, 8);
+      memcpy(&v2, pos + 16, 8);
+      memcpy(&v3, pos + 24, 8);
+      h0 ^= mix(v0);
+      h1 ^= mix(v1);
+      h2 ^= mix(v2);
+      h3 ^= mix(v3);
+      h0 *= m;
+      h1 *= m;
+      h2 *= m;
+      h3 *= m;
+    }
+
+    h = h0;
+    h ^= mix(h1);
+    h *= m;
+    h ^= mix(h2);
+    h *= m;
+    h ^= mix(h3);
+    h *= m;
+    len = rest;
+  }
+
+  return fasthash64_finish(pos, len, h);
+}
+
+// Number of independent keys fasthash64_batch() keeps in flight.
+#define BATCH_LANES 4
+
+// Sets up one lane of a batch group. A key shorter than a word is
+// replaced by its zero-extended tail in *pad, so that every lane can
+// load whole words with batch_word().
+static inline const unsigned char *batch_lane(const void *buf, size_t len,
+                                              uint64_t *pad, size_t *elen) {
+  if (len >= 8) {
+    *elen = len;
+    return (const unsigned char *)buf;
+  }
+  *pad = len ? load_tail((const unsigned char *)buf, len) : 0;
+  *elen = 8;
+  return (const unsigned char *)pad;
+}
+
+// Word k of a lane set up by batch_lane(), without branches: the 8
+// bytes at 8k, or for the last partial word the 8 bytes ending with
+// the key, shifted down to the bytes not absorbed yet. Past the end of
+// the key the value is garbage and the caller masks it out.
+static inline uint64_t batch_word(const unsigned char *p, size_t len,
+                                  size_t k) {
+  size_t off = 8 * k < len - 8 ? 8 * k : len - 8;
+  unsigned sh = (unsigned)(8 * (8 * k - off)) & 63;
+  uint64_t v;
+
+  memcpy(&v, p + off, 8);
+  return sh ? le64(v) >> sh : v;
+}
+
+// The lanes of a batch absorb words in lockstep until the longest key
+// of the group ends. Up to the shortest key's last full word every
+// lane takes a word each step; after that lanes whose key has ended
+// keep their hash, so keys of mixed length still overlap.
+static void fasthash64_batch_scalar(const void *const *bufs,
+                                    const size_t *lens, size_t n,
+                                    uint64_t seed, uint64_t *out) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  size_t i, j, k;
+
+  for (i = 0; i + BATCH_LANES <= n; i += BATCH_LANES) {
+    const unsigned char *pos[BATCH_LANES];
+    size_t len[BATCH_LANES], last[BATCH_LANES];
+    uint64_t h[BATCH_LANES], v[BATCH_LANES], pad[BATCH_LANES];
+    size_t words = (size_t)-1, steps = 0;
+
+    for (j = 0; j < BATCH_LANES; ++j) {
+      pos[j] = batch_lane(bufs[i + j], lens[i + j], &pad[j], &len[j]);
+      h[j] = seed ^ (lens[i + j] * m);
+      last[j] = (lens[i + j] + 7) / 8;
+      if (lens[i + j] / 8 < words)
+        words = lens[i + j] / 8;
+      if (last[j] > steps)
+        steps = last[j];
+    }
+
+    // the chains are independent, so their multiplies overlap
+    for (k = 0; k < words; ++k) {
+      for (j = 0; j < BATCH_LANES; ++j) {
+        memcpy(&v[j], pos[j] + 8 * k, 8);
+        h[j] ^= mix(v[j]);
+        h[j] *= m;
+      }
+    }
+
+    for (; k < steps; ++k) {
+      for (j = 0; j < BATCH_LANES; ++j) {
+        uint64_t hv;
+        v[j] = batch_word(pos[j], len[j], k);
+        hv = (h[j] ^ mix(v[j])) * m;
+        h[j] = k < last[j] ? hv : h[j];
+      }
+    }
+
+    for (j = 0; j < BATCH_LANES; ++j)
+      out[i + j] = mix(h[j]);
+  }
+
+  for (; i < n; ++i)
+    out[i] = fasthash64(bufs[i], lens[i], seed);
+}
+
+static void fasthash64_strided_scalar(const void *base, size_t width,
+                                      size_t stride, size_t n, uint64_t seed,
+                                      uint64_t *out) {
+  const unsigned char *rec = (const unsigned char *)base;
+  size_t i;
+
+  for (i = 0; i < n; ++i, rec += stride)
+    out[i] = fasthash64(rec, width, seed);
+}
+
+#ifdef FASTHASH_X86
+
+// Low 64 bits of a * b per lane, built from 32x32->64 multiplies.
+// bhi holds b >> 32 and is hoisted by the callers as b is constant.
+__attribute__((target("avx2"))) static inline __m256i
+mul64_avx2(__m256i a, __m256i b, __m256i bhi) {
+  __m256i lo = _mm256_mul_epu32(a, b);
+  __m256i t1 = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b);
+  __m256i t2 = _mm256_mul_epu32(a, bhi);
+  return _mm256_add_epi64(lo, _mm256_slli_epi64(_mm256_add_epi64(t1, t2), 32));
+}
+
+__attribute__((target("avx2"))) static inline __m256i mix_avx2(__m256i h) {
+  const __m256i c = _mm256_set1_epi64x(0x2127599bf4325c37LL);
+  const __m256i chi = _mm256_srli_epi64(c, 32);
+
+  h = _mm256_xor_si256(h, _mm256_srli_epi64(h, 23));
+  h = mul64_avx2(h, c, chi);
+  return _mm256_xor_si256(h, _mm256_srli_epi64(h, 47));
+}
+
+// One record per 64-bit lane, four records per iteration. The lanes
+// are filled with scalar loads, vpgatherqq is much slower on CPUs with
+// the gather data sampling mitigation.
+__attribute__((target("avx2"))) static void
+fasthash64_strided_avx2(const void *base, size_t width, size_t stride,
+                        size_t n, uint64_t seed, uint64_t *out) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  const __m256i vm = _mm256_set1_epi64x((long long)m);
+  const __m256i vmhi = _mm256_srli_epi64(vm, 32);
+  const __m256i h0 = _mm256_set1_epi64x((long long)(seed ^ (width * m)));
+  const unsigned char *rec = (const unsigned char *)base;
+  size_t words = width / 8;
+  size_t tail = width & 7;
+  size_t i, j, k;
+
+  for (i = 0; i + 4 <= n; i += 4, rec += 4 * stride) {
+    __m256i h = h0;
+    __m256i v;
+    uint64_t t[4];
+
+    for (k = 0; k < words; ++k) {
+      for (j = 0; j < 4; ++j)
+        memcpy(&t[j], rec + j * stride + 8 * k, 8);
+      v = _mm256_loadu_si256((const __m256i *)t);
+      h = _mm256_xor_si256(h, mix_avx2(v));
+      h = mul64_avx2(h, vm, vmhi);
+    }
+
+    if (tail) {
+      for (j = 0; j < 4; ++j)
+        t[j] = load_tail(rec + j * stride + 8 * words, tail);
+      v = _mm256_loadu_si256((const __m256i *)t);
+      h = _mm256_xor_si256(h, mix_avx2(v));
+      h = mul64_avx2(h, vm, vmhi);
+    }
+
+    _mm256_storeu_si256((__m256i *)(out + i), mix_avx2(h));
+  }
+
+  fasthash64_strided_scalar(rec, width, stride, n - i, seed, out + i);
+}
+
+// fasthash64_batch() with four keys in one vector, as in the scalar
+// kernel: lanes whose key has ended keep their hash through a blend.
+// The vectors are built from registers; storing the words and loading
+// them back as one vector would stall on store forwarding.
+__attribute__((target("avx2"))) static void
+fasthash64_batch_avx2(const void *const *bufs, const size_t *lens, size_t n,
+                      uint64_t seed, uint64_t *out) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  const __m256i vm = _mm256_set1_epi64x((long long)m);
+  const __m256i vmhi = _mm256_srli_epi64(vm, 32);
+  size_t i, j, k;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    const unsigned char *pos[4];
+    size_t len[4], last[4];
+    uint64_t pad[4], t[4], w[4];
+    size_t words = (size_t)-1, steps = 0;
+    __m256i h, v, hv, vlast;
+
+    for (j = 0; j < 4; ++j) {
+      pos[j] = batch_lane(bufs[i + j], lens[i + j], &pad[j], &len[j]);
+      t[j] = seed ^ (lens[i + j] * m);
+      last[j] = (lens[i + j] + 7) / 8;
+      if (lens[i + j] / 8 < words)
+        words = lens[i + j] / 8;
+      if (last[j] > steps)
+        steps = last[j];
+    }
+    h = _mm256_set_epi64x((long long)t[3], (long long)t[2], (long long)t[1],
+                          (long long)t[0]);
+    vlast = _mm256_set_epi64x((long long)last[3], (long long)last[2],
+                              (long long)last[1], (long long)last[0]);
+
+    for (k = 0; k < words; ++k) {
+      for (j = 0; j < 4; ++j)
+        memcpy(&w[j], pos[j] + 8 * k, 8);
+      v = _mm256_set_epi64x((long long)w[3], (long long)w[2],
+                            (long long)w[1], (long long)w[0]);
+      h = _mm256_xor_si256(h, mix_avx2(v));
+      h = mul64_avx2(h, vm, vmhi);
+    }
+
+    for (; k < steps; ++k) {
+      __m256i live =
+          _mm256_cmpgt_epi64(vlast, _mm256_set1_epi64x((long long)k));
+      for (j = 0; j < 4; ++j)
+        w[j] = batch_word(pos[j], len[j], k);
+      v = _mm256_set_epi64x((long long)w[3], (long long)w[2],
+                            (long long)w[1], (long long)w[0]);
+      hv = mul64_avx2(_mm256_xor_si256(h, mix_avx2(v)), vm, vmhi);
+      h = _mm256_blendv_epi8(h, hv, live);
+    }
+
+    _mm256_storeu_si256((__m256i *)(out + i), mix_avx2(h));
+  }
+
+  fasthash64_batch_scalar(bufs + i, lens + i, n - i, seed, out + i);
+}
+
+__attribute__((target("avx512f,avx512dq"))) static inline __m512i
+mix_avx512(__m512i h) {
+  const __m512i c = _mm512_set1_epi64(0x2127599bf4325c37LL);
+
+  h = _mm512_xor_si512(h, _mm512_srli_epi64(h, 23));
+  h = _mm512_mullo_epi64(h, c);
+  return _mm512_xor_si512(h, _mm512_srli_epi64(h, 47));
+}
+
+// One record per 64-bit lane, eight records per iteration, with the
+// native 64x64 vpmullq.
+__attribute__((target("avx512f,avx512dq"))) static void
+fasthash64_strided_avx512(const void *base, size_t width, size_t stride,
+                          size_t n, uint64_t seed, uint64_t *out) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  const __m512i vm = _mm512_set1_epi64((long long)m);
+  const __m512i h0 = _mm512_set1_epi64((long long)(seed ^ (width * m)));
+  const unsigned char *rec = (const unsigned char *)base;
+  size_t words = width / 8;
+  size_t tail = width & 7;
+  size_t i, j, k;
+
+  for (i = 0; i + 8 <= n; i += 8, rec += 8 * stride) {
+    __m512i h = h0;
+    __m512i v;
+    uint64_t t[8];
+
+    for (k = 0; k < words; ++k) {
+      for (j = 0; j < 8; ++j)
+        memcpy(&t[j], rec + j * stride + 8 * k, 8);
+      v = _mm512_loadu_si512(t);
+      h = _mm512_xor_si512(h, mix_avx512(v));
+      h = _mm512_mullo_epi64(h, vm);
+    }
+
+    if (tail) {
+      for (j = 0; j < 8; ++j)
+        t[j] = load_tail(rec + j * stride + 8 * words, tail);
+      v = _mm512_loadu_si512(t);
+      h = _mm512_xor_si512(h, mix_avx512(v));
+      h = _mm512_mullo_epi64(h, vm);
+    }
+
+    _mm512_storeu_si512(out + i, mix_avx512(h));
+  }
+
+  fasthash64_strided_avx2(rec, width, stride, n - i, seed, out + i);
+}
+
+__attribute__((target("avx512f,avx512dq"))) static void
+fasthash64_batch_avx512(const void *const *bufs, const size_t *lens,
+                        size_t n, uint64_t seed, uint64_t *out) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  const __m512i vm = _mm512_set1_epi64((long long)m);
+  size_t i, j, k;
+
+  for (i = 0; i + 8 <= n; i += 8) {
+    const unsigned char *pos[8];
+    size_t len[8], last[8];
+    uint64_t pad[8], t[8], w[8];
+    size_t words = (size_t)-1, steps = 0;
+    __m512i h, v, vlast;
+
+    for (j = 0; j < 8; ++j) {
+      pos[j] = batch_lane(bufs[i + j], lens[i + j], &pad[j], &len[j]);
+      t[j] = seed ^ (lens[i + j] * m);
+      last[j] = (lens[i + j] + 7) / 8;
+      if (lens[i + j] / 8 < words)
+        words = lens[i + j] / 8;
+      if (last[j] > steps)
+        steps = last[j];
+    }
+    h = _mm512_loadu_si512(t);
+    vlast = _mm512_loadu_si512(last);
+
+    for (k = 0; k < words; ++k) {
+      for (j = 0; j < 8; ++j)
+        memcpy(&w[j], pos[j] + 8 * k, 8);
+      v = _mm512_set_epi64((long long)w[7], (long long)w[6], (long long)w[5],
+                           (long long)w[4], (long long)w[3], (long long)w[2],
+                           (long long)w[1], (long long)w[0]);
+      h = _mm512_xor_si512(h, mix_avx512(v));
+      h = _mm512_mullo_epi64(h, vm);
+    }
+
+    // lanes whose key has ended keep their hash under the mask
+    for (; k < steps; ++k) {
+      __mmask8 live =
+          _mm512_cmpgt_epu64_mask(vlast, _mm512_set1_epi64((long long)k));
+      for (j = 0; j < 8; ++j)
+        w[j] = batch_word(pos[j], len[j], k);
+      v = _mm512_set_epi64((long long)w[7], (long long)w[6], (long long)w[5],
+                           (long long)w[4], (long long)w[3], (long long)w[2],
+                           (long long)w[1], (long long)w[0]);
+      h = _mm512_mask_mullo_epi64(h, live, _mm512_xor_si512(h, mix_avx512(v)),
+                                  vm);
+    }
+
+    _mm512_storeu_si512(out + i, mix_avx512(h));
+  }
+
+  fasthash64_batch_avx2(bufs + i, lens + i, n - i, seed, out + i);
+}
+
+#endif /* FASTHASH_X86 */
+
+// Runtime kernel dispatch. The table is ordered from the most to the
+// least preferred kernel; the first one the CPU supports is picked once
+// at load time unless FASTHASH_KERNEL names another one. fasthash64()
+// and fasthash32() are a single serial chain with nothing to vectorize,
+// so they are called directly instead of through the table.
+struct kernel_ops {
+  const char *name;
+  int (*supported)(void);
+  void (*batch)(const void *const *, const size_t *, size_t, uint64_t,
+                uint64_t *);
+  void (*strided)(const void *, size_t, size_t, size_t, uint64_t,
+                  uint64_t *);
+};
+
+static int cpu_scalar(void) { return 1; }
+
+#ifdef FASTHASH_X86
+static int cpu_avx2(void) { return __builtin_cpu_supports("avx2"); }
+
+static int cpu_avx512(void) {
+  return __builtin_cpu_supports("avx512f") &&
+         __builtin_cpu_supports("avx512dq");
+}
+#endif
+
+static const struct kernel_ops kernels[] = {
+#ifdef FASTHASH_X86
+    {"avx512", cpu_avx512, fasthash64_batch_avx512,
+     fasthash64_strided_avx512},
+    {"avx2", cpu_avx2, fasthash64_batch_avx2, fasthash64_strided_avx2},
+#endif
+    {"scalar", cpu_scalar, fasthash64_batch_scalar,
+     fasthash64_strided_scalar},
+};
+
+static const struct kernel_ops *kernel = NULL;
+
+int fasthash_select_kernel(const char *name) {
+  size_t i;
+
+#ifdef FASTHASH_X86
+  __builtin_cpu_init();
+#endif
+  for (i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i) {
+    if (name && strcmp(name, kernels[i].name))
+      continue;
+    if (kernels[i].supported()) {
+      kernel = &kernels[i];
+      return 0;
+    }
+  }
+  return -1;
+}
+
+__attribute__((constructor)) static void fasthash_dispatch_init(void) {
+  if (fasthash_select_kernel(getenv("FASTHASH_KERNEL")))
+    fasthash_select_kernel(NULL);
+}
+
+// covers calls from constructors that run before ours
+static inline const struct kernel_ops *get_kernel(void) {
+  if (__builtin_expect(kernel == NULL, 0))
+    fasthash_dispatch_init();
+  return kernel;
+}
+
+const char *fasthash_kernel_name(void) { return get_kernel()->name; }
+
+void fasthash64_batch(const void *const *bufs, const size_t *lens, size_t n,
+                      uint64_t seed, uint64_t *out) {
+  get_kernel()->batch(bufs, lens, n, seed, out);
+}
+
+void fasthash64_strided(const void *base, size_t width, size_t stride,
+                        size_t n, uint64_t seed, uint64_t *out) {
+  get_kernel()->strided(base, width, stride, n, seed, out);
+}
+
+void fasthash64_init(struct fasthash64_state *st, size_t len, uint64_t seed) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+
+  st->h = seed ^ (len * m);
+  st->left = len;
+  st->nbuf = 0;
+}
+
+void fasthash64_update(struct fasthash64_state *st, const void *buf,
+                       size_t len) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  const unsigned char *pos = (const unsigned char *)buf;
+  uint64_t h = st->h;
+  uint64_t v;
+
+  assert(len <= st->left);
+  st->left -= len;
+
+  // complete the word carried over from the previous fragment
+  if (st->nbuf) {
+    size_t n = 8 - st->nbuf;
+    if (n > len)
+      n = len;
+    memcpy(st->buf + st->nbuf, pos, n);
+    st->nbuf += n;
+    pos += n;
+    len -= n;
+    if (st->nbuf < 8)
+      return;
+    memcpy(&v, st->buf, 8);
+    h ^= mix(v);
+    h *= m;
+    st->nbuf = 0;
+  }
+
+  while (len >= 8) {
+    memcpy(&v, pos, 8);
+    h ^= mix(v);
+    h *= m;
+    pos += 8;
+    len -= 8;
+  }
+
+  memcpy(st->buf, pos, len);
+  st->nbuf = len;
+  st->h = h;
+}
+
+uint64_t fasthash64_final(const struct fasthash64_state *st) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  uint64_t h = st->h;
+  uint64_t v;
+
+  assert(st->left == 0);
+  if (st->nbuf) {
+    v = load_tail(st->buf, st->nbuf);
+    h ^= mix(v);
+    h *= m;
+  }
+
+  return mix(h);
+}
+
+uint64_t fasthash64_tree_root(const uint64_t *digests, size_t n,
+                              uint64_t seed) {
+  return fasthash64(digests, n * sizeof(uint64_t), seed);
+}
+
+uint64_t fasthash64_tree(const void *buf, size_t len, uint64_t seed) {
+  const unsigned char *p = (const unsigned char *)buf;
+  size_t n = (len + FASTHASH_TREE_CHUNK - 1) / FASTHASH_TREE_CHUNK;
+  struct fasthash64_state st;
+  size_t pos, clen;
+
+  // the root hash of the digests, without storing them. Offsets, not
+  // pointers, walk the chunks: no pointer past the end is formed.
+  fasthash64_init(&st, n * sizeof(uint64_t), seed);
+  for (pos = 0; pos < len; pos += clen) {
+    uint64_t d;
+    clen = len - pos < FASTHASH_TREE_CHUNK ? len - pos : FASTHASH_TREE_CHUNK;
+    d = fasthash64_wide(p + pos, clen, seed);
+    fasthash64_update(&st, &d, sizeof(d));
+  }
+
+  return fasthash64_final(&st);
+}
+
+#ifndef _WIN32
+uint64_t fasthash64_iov(const struct iovec *iov, int cnt, uint64_t seed) {
+  struct fasthash64_state st;
+  size_t len = 0;
+  int i;
+
+  for (i = 0; i < cnt; ++i)
+    len += iov[i].iov_len;
+
+  fasthash64_init(&st, len, seed);
+  for (i = 0; i < cnt; ++i)
+    fasthash64_update(&st, iov[i].iov_base, iov[i].iov_len);
+
+  return fasthash64_final(&st);
+}
+#endif
+
 uint32_t fasthash32(const void *buf, size_t len, uint32_t seed) {
   // the following trick converts the 64-bit hashcode to Fermat
   // residue, which shall retain information from both the higher
@@ -80,3 +741,111 @@ uint32_t fasthash32(const void *buf, size_t len, uint32_t seed) {
   uint64_t h = fasthash64(buf, len, seed);
   return h - (h >> 32);
 }
+
+// 32-bit compression function: the shift and multiplier of the first
+// half of MurmurHash3's fmix32, closed with the same shift.
+#define mix32(h)                                                               \
+  ({                                                                           \
+    (h) ^= (h) >> 16;                                                          \
+    (h) *= 0x85ebca6bU;                                                        \
+    (h) ^= (h) >> 16;                                                          \
+  })
+
+// fasthash64 scaled down to 32-bit words, so that 32-bit targets need
+// no 64x64 multiplies.
+uint32_t fasthash32_native(const void *buf, size_t len, uint32_t seed) {
+  // 2^32 / golden ratio, odd; PRIME32_1 of xxHash32
+  const uint32_t m = 0x9e3779b1U;
+  const unsigned char *pos = (const unsigned char *)buf;
+  const unsigned char *end = pos + (len & ~(size_t)3);
+  uint32_t h = seed ^ ((uint32_t)len * m);
+  uint32_t v;
+
+  for (; pos != end; pos += 4) {
+    memcpy(&v, pos, 4);
+    v = le32(v);
+    h ^= mix32(v);
+    h *= m;
+  }
+
+  if (len & 3) {
+    v = (uint32_t)load_tail(pos, len & 3);
+    h ^= mix32(v);
+    h *= m;
+  }
+
+  return mix32(h);
+}
+
+// Per-process key of fasthash64_secret(), drawn once at load time.
+static uint64_t secret[2];
+static int secret_ready;
+
+static int fill_random(void *p, size_t n) {
+#ifdef __linux__
+  if (getrandom(p, n, 0) == (ssize_t)n)
+    return 0;
+#endif
+#ifndef _WIN32
+  int fd = open("/dev/urandom", O_RDONLY);
+  if (fd >= 0) {
+    ssize_t r = read(fd, p, n);
+    close(fd);
+    if (r == (ssize_t)n)
+      return 0;
+  }
+#endif
+  return -1;
+}
+
+__attribute__((constructor)) static void fasthash_secret_init(void) {
+  if (fill_random(secret, sizeof(secret))) {
+    // last resort: weak, but still differs between runs
+    uint64_t t[3] = {(uint64_t)time(NULL), (uint64_t)clock(),
+                     (uint64_t)(uintptr_t)&t};
+    secret[0] = fasthash64(t, sizeof(t), 0);
+    secret[1] = fasthash64(t, sizeof(t), secret[0]);
+  }
+  secret_ready = 1;
+}
+
+// covers calls from constructors that run before ours
+static inline const uint64_t *get_secret(void) {
+  if (__builtin_expect(!secret_ready, 0))
+    fasthash_secret_init();
+  return secret;
+}
+
+// Each word is xored with k[0] before it is mixed. Keying only the
+// chain state is not enough: the difference mix(v) ^ mix(v') of two
+// words then does not depend on the key, and a second word can cancel
+// it whatever the key is. Through the multiply in mix() the difference
+// of the mixed words depends on v ^ k[0], so it cannot be planned.
+uint64_t fasthash64_secret(const void *buf, size_t len, uint64_t seed) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  const uint64_t *k = get_secret();
+  const unsigned char *pos = (const unsigned char *)buf;
+  const unsigned char *end = pos + (len & ~(size_t)7);
+  uint64_t h = seed ^ k[1] ^ (len * m);
+  uint64_t v;
+
+  for (; pos != end; pos += 8) {
+    memcpy(&v, pos, 8);
+    v ^= k[0];
+    h ^= mix(v);
+    h *= m;
+  }
+
+  if (len & 7) {
+    if (len >= 8)
+      v = load_tail_behind(pos, len & 7);
+    else
+      v = load_tail(pos, len & 7);
+    v ^= k[0];
+    h ^= mix(v);
+    h *= m;
+  }
+
+  h ^= k[1];
+  return mix(h);
+}
@@ -41,6 +41,18 @@ extern "C" {
  */
 uint32_t fasthash32(const void *buf, size_t len, uint32_t seed);
 
+/**
+ * fasthash32_native - 32-bit fasthash using 32-bit multiplies only
+ * @buf:  data buffer
+ * @len:  data size
+ * @seed: the seed
+ *
+ * For 32-bit targets such as i386 and ARMv7, where fasthash32() has to
+ * emulate 64-bit multiplies. Absorbs 4-byte words; the results differ
+ * from fasthash32().
+ */
+uint32_t fasthash32_native(const void *buf, size_t len, uint32_t seed);
+
 /**
  * fasthash64 - 64-bit implementation of fasthash
  * @buf:  data buffer
@@ -49,8 +61,288 @@ uint32_t fasthash32(const void *buf, size_t len, uint32_t seed);
  */
 uint64_t fasthash64(const void *buf, size_t len, uint64_t seed);
 
+/**
+ * fasthash128 - 128-bit implementation of fasthash
+ * @buf:  data buffer
+ * @len:  data size
+ * @seed: the seed
+ * @out:  receives the hash value, two 64-bit words
+ */
+void fasthash128(const void *buf, size_t len, uint64_t seed, uint64_t out[2]);
+
+/**
+ * fasthash64_wide - 4-lane variant of fasthash64 for large buffers
+ * @buf:  data buffer
+ * @len:  data size
+ * @seed: the seed
+ *
+ * Several times faster than fasthash64() on inputs of a few kilobytes
+ * and up. Its output differs from fasthash64() once @len reaches 32
+ * bytes, below that both return the same value.
+ */
+uint64_t fasthash64_wide(const void *buf, size_t len, uint64_t seed);
+
+/* chunk size of fasthash64_tree() */
+#define FASTHASH_TREE_CHUNK (1 << 20)
+
+/**
+ * fasthash64_tree - tree mode fasthash for large inputs
+ * @buf:  data buffer
+ * @len:  data size
+ * @seed: the seed
+ *
+ * The input is cut into FASTHASH_TREE_CHUNK byte chunks, the last one
+ * possibly shorter. Chunk i is digested with fasthash64_wide(chunk,
+ * chunk size, @seed) and the result is fasthash64_tree_root() of the
+ * digests in order. The chunks are independent and may be hashed in
+ * parallel; this function is the sequential reference.
+ */
+uint64_t fasthash64_tree(const void *buf, size_t len, uint64_t seed);
+
+/**
+ * fasthash64_tree_root - combine the chunk digests of fasthash64_tree
+ * @digests: array of @n chunk digests
+ * @n:       number of chunks
+ * @seed:    the seed
+ */
+uint64_t fasthash64_tree_root(const uint64_t *digests, size_t n,
+                              uint64_t seed);
+
+struct iovec;
+
+/**
+ * fasthash64_iov - fasthash64 of the concatenation of several buffers
+ * @iov:  the buffers
+ * @cnt:  number of buffers
+ * @seed: the seed
+ *
+ * Equals fasthash64() of the buffers copied back to back, e.g. for
+ * composite keys kept in separate fields. Words that straddle buffer
+ * boundaries are carried over, nothing else is copied. POSIX only.
+ */
+uint64_t fasthash64_iov(const struct iovec *iov, int cnt, uint64_t seed);
+
+/**
+ * fasthash64_secret - fasthash64 keyed with a per-process secret
+ * @buf:  data buffer
+ * @len:  data size
+ * @seed: the seed
+ *
+ * The 128-bit secret comes from getrandom() (or /dev/urandom) once at
+ * load time. Half of it is xored into every input word before the
+ * word is mixed, the other half into the seed and the finalizer, so
+ * how two keys differ after mixing depends on the secret and key sets
+ * that collide for fasthash64() cannot be precomputed. Use it for
+ * hash tables fed with untrusted keys. Results differ between runs and
+ * must not be stored. Not a cryptographic MAC.
+ */
+uint64_t fasthash64_secret(const void *buf, size_t len, uint64_t seed);
+
+/**
+ * fasthash64_batch - hash many independent keys at once
+ * @bufs: array of @n data buffers
+ * @lens: array of @n data sizes
+ * @n:    number of keys
+ * @seed: the seed shared by all keys
+ * @out:  array receiving the @n hash values
+ *
+ * Interleaves several keys so that their multiply chains overlap; a
+ * group of keys runs until its longest key ends. out[i] equals
+ * fasthash64(bufs[i], lens[i], seed). Keys of similar length gain
+ * most; out-of-order cores overlap a plain fasthash64() loop too, so
+ * compare the "mixed" rows of hashgen/bench on the target CPU.
+ */
+void fasthash64_batch(const void *const *bufs, const size_t *lens, size_t n,
+                      uint64_t seed, uint64_t *out);
+
+/**
+ * fasthash64_strided - hash a column of fixed-width records
+ * @base:   address of the first record
+ * @width:  size of each record
+ * @stride: distance in bytes between consecutive records
+ * @n:      number of records
+ * @seed:   the seed shared by all records
+ * @out:    array receiving the @n hash values
+ *
+ * Runs one record per SIMD lane where AVX2 or AVX-512 is available.
+ * out[i] equals fasthash64((const char *)base + i * stride, width, seed).
+ */
+void fasthash64_strided(const void *base, size_t width, size_t stride,
+                        size_t n, uint64_t seed, uint64_t *out);
+
+/**
+ * fasthash64_state - incremental fasthash64 context
+ * @h:    running hash value
+ * @left: bytes of the size declared to fasthash64_init() not fed yet
+ * @nbuf: number of bytes held in @buf
+ * @buf:  partial 8-byte word carried across fragments
+ */
+struct fasthash64_state {
+  uint64_t h;
+  size_t left;
+  size_t nbuf;
+  unsigned char buf[8];
+};
+
+/**
+ * fasthash64_init - start an incremental fasthash64 computation
+ * @st:   the state
+ * @len:  total number of bytes that will be fed by fasthash64_update()
+ * @seed: the seed
+ *
+ * The data size is folded into the initial hash value, so it has to
+ * be known up front. The result of fasthash64_final() equals
+ * fasthash64(buf, len, seed) only if exactly @len bytes were fed.
+ */
+void fasthash64_init(struct fasthash64_state *st, size_t len, uint64_t seed);
+
+/**
+ * fasthash64_update - feed the next fragment of data
+ * @st:  the state
+ * @buf: data fragment, no alignment required
+ * @len: fragment size, may be zero
+ */
+void fasthash64_update(struct fasthash64_state *st, const void *buf,
+                       size_t len);
+
+/**
+ * fasthash64_final - return the hash of all fed data
+ * @st: the state, left untouched
+ *
+ * Feeding more or fewer bytes than declared to fasthash64_init() is a
+ * bug, caught by an assertion unless NDEBUG is defined.
+ */
+uint64_t fasthash64_final(const struct fasthash64_state *st);
+
+/**
+ * fasthash_select_kernel - force the SIMD kernel set used by
+ * fasthash64_batch() and fasthash64_strided()
+ * @name: "avx512", "avx2" or "scalar"; NULL picks the best supported one
+ *
+ * The kernel is normally chosen once at load time, honoring the
+ * FASTHASH_KERNEL environment variable. Returns 0 on success, or -1
+ * if @name is unknown or not supported by this CPU.
+ */
+int fasthash_select_kernel(const char *name);
+
+/**
+ * fasthash_kernel_name - name of the kernel set in use
+ */
+const char *fasthash_kernel_name(void);
+
+/* Fixed-length keys: the loop and the tail switch of fasthash64 are
+ * fully unrolled, leaving a couple of multiplies per key. */
+
+static inline uint64_t fasthash_mix(uint64_t h) {
+  h ^= h >> 23;
+  h *= 0x2127599bf4325c37ULL;
+  h ^= h >> 47;
+  return h;
+}
+
+/**
+ * fasthash64_u32 - fasthash64 of a 4-byte key
+ * @k:    the key
+ * @seed: the seed
+ *
+ * Equals fasthash64(&k, sizeof(k), seed).
+ */
+static inline uint64_t fasthash64_u32(uint32_t k, uint64_t seed) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  uint64_t h = seed ^ (4 * m);
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  k = __builtin_bswap32(k); /* the tail bytes are read little-endian */
+#endif
+  h ^= fasthash_mix(k);
+  h *= m;
+  return fasthash_mix(h);
+}
+
+/**
+ * fasthash64_u64 - fasthash64 of an 8-byte key
+ * @k:    the key
+ * @seed: the seed
+ *
+ * Equals fasthash64(&k, sizeof(k), seed).
+ */
+static inline uint64_t fasthash64_u64(uint64_t k, uint64_t seed) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  uint64_t h = seed ^ (8 * m);
+
+  h ^= fasthash_mix(k);
+  h *= m;
+  return fasthash_mix(h);
+}
+
+/**
+ * fasthash64_u128 - fasthash64 of a 16-byte key
+ * @lo:   the first 8 bytes of the key in memory
+ * @hi:   the last 8 bytes of the key in memory
+ * @seed: the seed
+ *
+ * Equals fasthash64() of the 16 bytes {lo, hi}, which on little-endian
+ * hosts is the layout of an unsigned __int128.
+ */
+static inline uint64_t fasthash64_u128(uint64_t lo, uint64_t hi,
+                                       uint64_t seed) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  uint64_t h = seed ^ (16 * m);
+
+  h ^= fasthash_mix(lo);
+  h *= m;
+  h ^= fasthash_mix(hi);
+  h *= m;
+  return fasthash_mix(h);
+}
+
 #ifdef __cplusplus
 }
+
+#include <string.h>
+
+template <size_t N> struct fasthash64_fixed {
+  static uint64_t hash(const void *k, uint64_t seed) {
+    return fasthash64(k, N, seed);
+  }
+};
+
+template <> struct fasthash64_fixed<4> {
+  static uint64_t hash(const void *k, uint64_t seed) {
+    uint32_t v;
+    memcpy(&v, k, sizeof(v));
+    return fasthash64_u32(v, seed);
+  }
+};
+
+template <> struct fasthash64_fixed<8> {
+  static uint64_t hash(const void *k, uint64_t seed) {
+    uint64_t v;
+    memcpy(&v, k, sizeof(v));
+    return fasthash64_u64(v, seed);
+  }
+};
+
+template <> struct fasthash64_fixed<16> {
+  static uint64_t hash(const void *k, uint64_t seed) {
+    uint64_t v[2];
+    memcpy(v, k, sizeof(v));
+    return fasthash64_u128(v[0], v[1], seed);
+  }
+};
+
+/**
+ * fasthash64_key - fasthash64 of a fixed-size key, unrolled for 4, 8
+ * and 16 bytes
+ * @k:    the key, e.g. an integer or a pair of integers
+ * @seed: the seed
+ *
+ * Equals fasthash64(&k, sizeof(k), seed).
+ */
+template <typename T>
+inline uint64_t fasthash64_key(const T &k, uint64_t seed) {
+  return fasthash64_fixed<sizeof(T)>::hash(&k, seed);
+}
 #endif
 
 #endif
@@ -0,0 +1,167 @@
+/* The MIT License
+
+   Copyright (C) 2012 Zilong Tan (eric.zltan@gmail.com)
+   Copyright (C) 2024 Reini Urban (reini.urban@gmail.com)
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without
+   restriction, including without limitation the rights to use, copy,
+   modify, merge, publish, distribute, sublicense, and/or sell copies
+   of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+// Header-only constexpr fasthash for C++17 and later. The results are
+// identical to fasthash64() and fasthash32() from fasthash.c, so hashes
+// computed at compile time can be compared with runtime ones.
+
+#ifndef _FASTHASH_HPP
+#define _FASTHASH_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string_view>
+#if __cplusplus >= 202002L
+#include <cstddef>
+#include <span>
+#endif
+
+namespace fasthash {
+
+namespace detail {
+
+constexpr uint64_t mix(uint64_t h) {
+  h ^= h >> 23;
+  h *= 0x2127599bf4325c37ULL;
+  h ^= h >> 47;
+  return h;
+}
+
+template <typename Byte> constexpr uint64_t byte(const Byte *p, size_t i) {
+  return static_cast<unsigned char>(p[i]);
+}
+
+// Assembles a word in host byte order, as fasthash.c loads it with a
+// plain 64-bit read. Compilers turn this into a single load.
+template <typename Byte> constexpr uint64_t load64(const Byte *p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return byte(p, 7) | byte(p, 6) << 8 | byte(p, 5) << 16 |
+         byte(p, 4) << 24 | byte(p, 3) << 32 | byte(p, 2) << 40 |
+         byte(p, 1) << 48 | byte(p, 0) << 56;
+#else
+  return byte(p, 0) | byte(p, 1) << 8 | byte(p, 2) << 16 |
+         byte(p, 3) << 24 | byte(p, 4) << 32 | byte(p, 5) << 40 |
+         byte(p, 6) << 48 | byte(p, 7) << 56;
+#endif
+}
+
+// The trailing len & 7 bytes are always little-endian.
+template <typename Byte>
+constexpr uint64_t load_tail(const Byte *p, size_t n) {
+  uint64_t v = 0;
+  for (size_t i = 0; i < n; ++i)
+    v |= byte(p, i) << (8 * i);
+  return v;
+}
+
+template <typename Byte>
+constexpr uint64_t hash64(const Byte *buf, size_t len, uint64_t seed) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  uint64_t h = seed ^ (len * m);
+
+  for (size_t i = 0; i < len / 8; ++i) {
+    h ^= mix(load64(buf + 8 * i));
+    h *= m;
+  }
+
+  if (len & 7) {
+    h ^= mix(load_tail(buf + (len & ~static_cast<size_t>(7)), len & 7));
+    h *= m;
+  }
+
+  return mix(h);
+}
+
+template <typename Byte>
+constexpr uint32_t hash32(const Byte *buf, size_t len, uint32_t seed) {
+  uint64_t h = hash64(buf, len, seed);
+  return static_cast<uint32_t>(h - (h >> 32));
+}
+
+} // namespace detail
+
+/**
+ * fasthash64 - constexpr 64-bit fasthash
+ * @s:    data
+ * @seed: the seed
+ */
+constexpr uint64_t fasthash64(std::string_view s, uint64_t seed = 0) {
+  return detail::hash64(s.data(), s.size(), seed);
+}
+
+constexpr uint64_t fasthash64(const unsigned char *buf, size_t len,
+                              uint64_t seed = 0) {
+  return detail::hash64(buf, len, seed);
+}
+
+/**
+ * fasthash32 - constexpr 32-bit fasthash
+ * @s:    data
+ * @seed: the seed
+ */
+constexpr uint32_t fasthash32(std::string_view s, uint32_t seed = 0) {
+  return detail::hash32(s.data(), s.size(), seed);
+}
+
+constexpr uint32_t fasthash32(const unsigned char *buf, size_t len,
+                              uint32_t seed = 0) {
+  return detail::hash32(buf, len, seed);
+}
+
+#if __cplusplus >= 202002L
+constexpr uint64_t fasthash64(std::span<const std::byte> s,
+                              uint64_t seed = 0) {
+  return detail::hash64(s.data(), s.size(), seed);
+}
+
+constexpr uint64_t fasthash64(std::span<const unsigned char> s,
+                              uint64_t seed = 0) {
+  return detail::hash64(s.data(), s.size(), seed);
+}
+
+constexpr uint32_t fasthash32(std::span<const std::byte> s,
+                              uint32_t seed = 0) {
+  return detail::hash32(s.data(), s.size(), seed);
+}
+
+constexpr uint32_t fasthash32(std::span<const unsigned char> s,
+                              uint32_t seed = 0) {
+  return detail::hash32(s.data(), s.size(), seed);
+}
+#endif
+
+namespace literals {
+
+// "key"_fh is fasthash64("key", 3, 0), e.g. for switch case labels
+constexpr uint64_t operator""_fh(const char *s, size_t len) {
+  return detail::hash64(s, len, 0);
+}
+
+} // namespace literals
+
+} // namespace fasthash
+
+#endif
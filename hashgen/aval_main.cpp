@@ -34,6 +34,29 @@ static uint64_t fasthash64_noseed(const void *buf, size_t len) {
   return fasthash64(buf, len, 0);
 }
 
+static uint64_t fasthash64_wide_noseed(const void *buf, size_t len) {
+  return fasthash64_wide(buf, len, 0);
+}
+
+static uint64_t fasthash128_lo_noseed(const void *buf, size_t len) {
+  uint64_t h[2];
+  fasthash128(buf, len, 0, h);
+  return h[0];
+}
+
+static uint64_t fasthash128_hi_noseed(const void *buf, size_t len) {
+  uint64_t h[2];
+  fasthash128(buf, len, 0, h);
+  return h[1];
+}
+
+static uint64_t fasthash32_native_noseed(const void *buf, size_t len) {
+  uint64_t low, high;
+  low = fasthash32_native(buf, len, 0);
+  high = fasthash32_native(buf, len, 1);
+  return low | (high << 32);
+}
+
 static uint64_t hash_jenkins_noseed(const void *buf, size_t len) {
   uint64_t hash = 0x0000000100000001ULL;
   uint32_t *ph = (uint32_t *)&hash;
@@ -56,6 +79,18 @@ int main() {
   // 2.272378
   printf("Overall quality of fasthash    : %f\n",
          aval(fasthash64_noseed, 49, 5000));
+  // 2.484725
+  printf("Overall quality of fasthash_wide: %f\n",
+         aval(fasthash64_wide_noseed, 49, 5000));
+  // 1.718118
+  printf("Overall quality of fasthash128[0]: %f\n",
+         aval(fasthash128_lo_noseed, 49, 5000));
+  // 2.010513
+  printf("Overall quality of fasthash128[1]: %f\n",
+         aval(fasthash128_hi_noseed, 49, 5000));
+  // 3.036793
+  printf("Overall quality of fasthash32_native: %f\n",
+         aval(fasthash32_native_noseed, 49, 5000));
   // 3.463349
   printf("Overall quality of xxhash      : %f\n",
          aval(hash_xxhash_noseed, 49, 5000));
@@ -45,6 +45,11 @@
 // exported symbols
 float volatile g_aval_r = 0.1;
 float volatile g_indep_r = 2.0;
+float volatile g_aval_k = 3.0;
+
+// samples per input bit of the first early abort round; small, so a
+// clearly worse candidate costs little more than its timing
+#define FIRST_ROUND 8
 
 // independence test
 static inline float indep_score(unsigned char *s, int num) {
@@ -71,6 +76,16 @@ static inline float indep_score(unsigned char *s, int num) {
   return fabs(r - mean + 0.5) / sqrt(var);
 }
 
+static float max_bias(const float mat[][64], int nbit) {
+  float b = 0;
+
+  for (int i = 0; i < nbit; ++i)
+    for (int j = 0; j < 64; ++j)
+      if (fabsf(mat[i][j] - 0.5f) > b)
+        b = fabsf(mat[i][j] - 0.5f);
+  return b;
+}
+
 static void binary_classify(const float mat[][64], int max,
                             unsigned char *sample) {
   int i;
@@ -79,11 +94,28 @@ static void binary_classify(const float mat[][64], int max,
     sample[i] = mat[i >> 6][i & 0x3f] > 0.5;
 }
 
-avalanche::avalanche() {
+avalanche::avalanche() : _bias(0) {
   uint64_t seed = (uint64_t)time(NULL);
   RAND_NR_INIT(_u, _v, _w, seed);
 }
 
+// for concurrent instances, which must not share a time(NULL) seed
+avalanche::avalanche(uint64_t seed) : _bias(0) {
+  RAND_NR_INIT(_u, _v, _w, seed);
+}
+
+void avalanche::get_state(uint64_t s[]) const {
+  s[0] = _u;
+  s[1] = _v;
+  s[2] = _w;
+}
+
+void avalanche::set_state(const uint64_t s[]) {
+  _u = s[0];
+  _v = s[1];
+  _w = s[2];
+}
+
 void avalanche::sample(uint64_t diff, float m[]) {
   while (diff) {
     ++m[ffs64(diff) - 1];
@@ -115,6 +147,44 @@ float avalanche::evaluate(const float mat[][64], int nbit) {
   return (r / (nbit * 64)) * g_aval_r + s * g_indep_r;
 }
 
+// A flip probability estimated from n samples has a standard deviation
+// of at most 0.5 / sqrt(n), so shrinking |p - 0.5| by g_aval_k of them
+// bounds the true bias. The final estimate from times samples has an
+// expected |p - 0.5| of at least that bias and at least the noise floor
+// 0.5 * sqrt(2 / (pi * times)), and the score of a cell is convex in
+// it. Averaged over all cells the floor holds to well under the 5%
+// taken off. The runs test statistic is roughly standard normal for a
+// good function at any n, so g_aval_k is taken off it as well.
+float avalanche::evaluate_bound(const float cnt[][64], int nbit, int n,
+                                int times) {
+  float r = 0;
+  float m, s;
+  float d = g_aval_k * 0.5 / sqrt(n);
+  float floor = 0.95 * 0.5 * sqrt(2 / (M_PI * times));
+  int i, j;
+  int bin_max = 64 * nbit;
+
+  unsigned char bin[bin_max + 1];
+  bin[bin_max] = 0; // reserved for special use
+  for (i = 0; i < bin_max; ++i)
+    bin[i] = cnt[i >> 6][i & 0x3f] > 0.5 * n;
+  s = indep_score(bin, bin_max) - g_aval_k;
+  if (s < 0)
+    s = 0;
+
+  for (i = 0; i < nbit; ++i) {
+    for (j = 0; j < 64; ++j) {
+      m = cnt[i][j] / n - 0.5;
+      m = (m < 0 ? -m : m) - d;
+      if (m < floor)
+        m = floor;
+      r += expf(m + 8.0) - 2980.95798704172827474359;
+    }
+  }
+
+  return (r / (nbit * 64)) * g_aval_r + s * g_indep_r;
+}
+
 // fill full random numbers
 void avalanche::_rand_fill(void *buf, size_t len) {
   uint64_t n;
@@ -173,7 +243,8 @@ void avalanche::_rand_fill(void *buf, size_t len)
 }
 */
 
-void avalanche::measure(float mat[][64], hash_func_t f, int len, int times) {
+void avalanche::_accumulate(float cnt[][64], hash_func_t f, int len,
+                            int times) {
   int i, n;
   int nbit = len << 3;
 
@@ -186,11 +257,19 @@ void avalanche::measure(float mat[][64], hash_func_t f, int len, int times) {
       buf[i >> 3] ^= 1 << (i & 7);
       newhash = f(buf, len);
       newhash ^= hash;
-      sample(newhash, mat[i]);
+      sample(newhash, cnt[i]);
     }
+  }
+}
+
+void avalanche::measure(float mat[][64], hash_func_t f, int len, int times) {
+  int i, n;
+  int nbit = len << 3;
+
+  _accumulate(mat, f, len, times);
+  for (i = 0; i < nbit; ++i)
     for (n = 0; n < 64; ++n)
       mat[i][n] /= times;
-  }
 }
 
 float avalanche::operator()(hash_func_t f, int len, int times) {
@@ -201,5 +280,41 @@ float avalanche::operator()(hash_func_t f, int len, int times) {
   for (i = 0; i < nbit; ++i)
     memset(mat[i], 0, sizeof(float) * 64);
   measure(mat, f, len, times);
+  _bias = max_bias(mat, nbit);
+  return evaluate(mat, nbit);
+}
+
+float avalanche::operator()(hash_func_t f, int len, int times, float limit,
+                            bool *early) {
+  int i, n, done = 0;
+  int nbit = len << 3;
+  int round = FIRST_ROUND;
+  float mat[nbit][64];
+  float lb;
+
+  *early = false;
+  if (g_aval_k <= 0)
+    return (*this)(f, len, times);
+
+  for (i = 0; i < nbit; ++i)
+    memset(mat[i], 0, sizeof(float) * 64);
+  while (done < times) {
+    if (round > times - done)
+      round = times - done;
+    _accumulate(mat, f, len, round);
+    done += round;
+    round = done; // doubles the sample count
+    if (done < times) {
+      lb = evaluate_bound(mat, nbit, done, times);
+      if (lb >= limit) {
+        *early = true;
+        return lb;
+      }
+    }
+  }
+  for (i = 0; i < nbit; ++i)
+    for (n = 0; n < 64; ++n)
+      mat[i][n] /= times;
+  _bias = max_bias(mat, nbit);
   return evaluate(mat, nbit);
 }
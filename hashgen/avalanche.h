@@ -32,6 +32,8 @@
 // score ratios
 extern float volatile g_aval_r;
 extern float volatile g_indep_r;
+// confidence of early abort in standard deviations, 0 to disable
+extern float volatile g_aval_k;
 
 #define DEF_IND 10.0
 
@@ -40,21 +42,45 @@ public:
   typedef uint64_t (*hash_func_t)(const void *, size_t);
 
   avalanche();
+  explicit avalanche(uint64_t seed);
 
   static void sample(uint64_t diff, float m[]);
 
   // evaluate the quality of test hash function
   static float evaluate(const float mat[][64], int nbit);
 
+  // lower confidence bound of evaluate() after times samples per input
+  // bit, given the bit flip counts cnt of the first n of them
+  static float evaluate_bound(const float cnt[][64], int nbit, int n,
+                              int times);
+
   void measure(float mat[][64], hash_func_t f, int len, int times);
 
   float operator()(hash_func_t f, int len, int times);
 
+  // largest |p - 0.5| of the last complete measurement
+  float bias() const { return _bias; }
+
+  // the RNG context, three words, for checkpoints
+  void get_state(uint64_t s[]) const;
+
+  void set_state(const uint64_t s[]);
+
+  // samples in doubling rounds and stops once the score is known to
+  // stay above limit, returning the lower bound reached; *early tells
+  // whether that happened
+  float operator()(hash_func_t f, int len, int times, float limit,
+                   bool *early);
+
 private:
   // fill buf with random numbers
   void _rand_fill(void *buf, size_t len);
 
+  // adds times samples to the bit flip counts of each input bit
+  void _accumulate(float cnt[][64], hash_func_t f, int len, int times);
+
   uint64_t _u, _v, _w; // RNG context
+  float _bias;
 };
 
 #endif
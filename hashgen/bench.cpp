@@ -0,0 +1,248 @@
+/* The MIT License
+
+   Copyright (C) 2024 Reini Urban (reini.urban@gmail.com)
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without
+   restriction, including without limitation the rights to use, copy,
+   modify, merge, publish, distribute, sublicense, and/or sell copies
+   of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+// bench - cycles per hash of fasthash and the reference hashes, as CSV
+//
+// Every function is timed with rdtsc on one pinned CPU, for lengths
+// 0..64 and powers of two up to 1 MiB, in two modes:
+//   latency:    each call is seeded with the previous hash, so calls
+//               cannot overlap
+//   throughput: independent keys at varying offsets
+// and, for fasthash64 and fasthash64_batch, over MIXED_KEYS keys of
+// 8..64 random bytes:
+//   mixed:      one call per key, or one fasthash64_batch() call
+// Each value is the median of REPEATS runs. rdtsc counts reference
+// cycles, so fix the CPU frequency for comparable numbers.
+
+#include "../fasthash.h"
+#include "xxhash.h"
+#include <algorithm>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ulib/hash.h>
+#include <ulib/rand_tpl.h>
+#include <ulib/rdtsc.h>
+
+#define MAX_LEN (1 << 20)
+#define REPEATS 5
+// bytes hashed per run, within the call limits below
+#define RUN_BYTES (4 << 20)
+#define MIN_CALLS 16
+#define MAX_CALLS 100000
+#define MIXED_KEYS 4096
+#define MIXED_RUNS 64
+
+typedef uint64_t (*hash_fn)(const void *, size_t, uint64_t);
+
+static uint64_t b_fasthash64(const void *buf, size_t len, uint64_t seed) {
+  return fasthash64(buf, len, seed);
+}
+
+static uint64_t b_fasthash32(const void *buf, size_t len, uint64_t seed) {
+  return fasthash32(buf, len, seed);
+}
+
+static uint64_t b_fasthash32_native(const void *buf, size_t len,
+                                    uint64_t seed) {
+  return fasthash32_native(buf, len, seed);
+}
+
+static uint64_t b_hash_fast64(const void *buf, size_t len, uint64_t seed) {
+  return hash_fast64(buf, len, seed);
+}
+
+static uint64_t b_hash_jenkins(const void *buf, size_t len, uint64_t seed) {
+  return hash_jenkins(buf, len, seed);
+}
+
+static uint64_t b_xxh_fast32(const void *buf, size_t len, uint64_t seed) {
+  return XXH_fast32(buf, len, seed);
+}
+
+static const struct {
+  const char *name;
+  hash_fn f;
+} funcs[] = {
+    {"fasthash64", b_fasthash64},
+    {"fasthash32", b_fasthash32},
+    {"fasthash32_native", b_fasthash32_native},
+    {"hash_fast64", b_hash_fast64},
+    {"hash_jenkins", b_hash_jenkins},
+    {"XXH_fast32", b_xxh_fast32},
+};
+
+static unsigned char g_buf[MAX_LEN + 64];
+static volatile uint64_t g_sink;
+
+static const void *g_keys[MIXED_KEYS];
+static size_t g_key_lens[MIXED_KEYS];
+static uint64_t g_out[MIXED_KEYS];
+
+__attribute__((noinline)) static uint64_t run_latency(hash_fn f, size_t len,
+                                                      int calls) {
+  uint64_t h = 0;
+
+  for (int i = 0; i < calls; ++i)
+    h = f(g_buf, len, h);
+  return h;
+}
+
+__attribute__((noinline)) static uint64_t run_throughput(hash_fn f,
+                                                         size_t len,
+                                                         int calls) {
+  uint64_t h = 0;
+
+  for (int i = 0; i < calls; ++i)
+    h += f(g_buf + (i & 63), len, 0);
+  return h;
+}
+
+// median cycles per call
+static double measure(uint64_t (*run)(hash_fn, size_t, int), hash_fn f,
+                      size_t len) {
+  size_t calls = RUN_BYTES / (len + 1);
+  double c[REPEATS];
+
+  if (calls < MIN_CALLS)
+    calls = MIN_CALLS;
+  if (calls > MAX_CALLS)
+    calls = MAX_CALLS;
+  g_sink += run(f, len, calls); // warm up
+  for (int r = 0; r < REPEATS; ++r) {
+    uint64_t start = rdtsc();
+    g_sink += run(f, len, calls);
+    c[r] = (double)(rdtsc() - start) / calls;
+  }
+  std::sort(c, c + REPEATS);
+  return c[REPEATS / 2];
+}
+
+__attribute__((noinline)) static void run_mixed_loop() {
+  for (int i = 0; i < MIXED_KEYS; ++i)
+    g_out[i] = fasthash64(g_keys[i], g_key_lens[i], 0);
+}
+
+__attribute__((noinline)) static void run_mixed_batch() {
+  fasthash64_batch(g_keys, g_key_lens, MIXED_KEYS, 0, g_out);
+}
+
+// median cycles per key
+static double measure_mixed(void (*run)()) {
+  double c[REPEATS];
+
+  run(); // warm up
+  for (int r = 0; r < REPEATS; ++r) {
+    uint64_t start = rdtsc();
+    for (int i = 0; i < MIXED_RUNS; ++i)
+      run();
+    c[r] = (double)(rdtsc() - start) / MIXED_RUNS / MIXED_KEYS;
+    g_sink += g_out[r];
+  }
+  std::sort(c, c + REPEATS);
+  return c[REPEATS / 2];
+}
+
+static void report(const char *name, const char *mode, size_t len,
+                   double cycles) {
+  printf("%s,%s,%zu,%.2f,%.3f\n", name, mode, len, cycles,
+         len ? cycles / len : 0.0);
+  fflush(stdout);
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [-c cpu] [-f function]\n"
+          "Prints cycles per hash and per byte as CSV.\n",
+          prog);
+}
+
+int main(int argc, char *argv[]) {
+  const char *only = NULL;
+  int cpu = sched_getcpu();
+  cpu_set_t set;
+  uint64_t u, v, w;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "c:f:h")) != -1) {
+    switch (opt) {
+    case 'c':
+      cpu = atoi(optarg);
+      break;
+    case 'f':
+      only = optarg;
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (sched_setaffinity(0, sizeof(set), &set)) {
+    perror("sched_setaffinity");
+    return 1;
+  }
+  fprintf(stderr, "pinned to cpu %d\n", cpu);
+
+  RAND_NR_INIT(u, v, w, 0x5eed);
+  for (size_t i = 0; i < sizeof(g_buf); ++i)
+    g_buf[i] = (unsigned char)RAND_NR_NEXT(u, v, w);
+
+  size_t mixed_len = 0;
+  for (int i = 0; i < MIXED_KEYS; ++i) {
+    g_key_lens[i] = 8 + RAND_NR_NEXT(u, v, w) % 57;
+    g_keys[i] = g_buf + RAND_NR_NEXT(u, v, w) % (MAX_LEN - 64);
+    mixed_len += g_key_lens[i];
+  }
+  mixed_len /= MIXED_KEYS;
+
+  printf("function,mode,len,cycles_per_hash,cycles_per_byte\n");
+  for (size_t i = 0; i < sizeof(funcs) / sizeof(funcs[0]); ++i) {
+    if (only && strcmp(only, funcs[i].name))
+      continue;
+    // 0..64 byte by byte, then powers of two
+    for (size_t len = 0; len <= MAX_LEN; len = len < 64 ? len + 1 : len * 2) {
+      report(funcs[i].name, "latency", len,
+             measure(run_latency, funcs[i].f, len));
+      report(funcs[i].name, "throughput", len,
+             measure(run_throughput, funcs[i].f, len));
+    }
+  }
+  // len is the mean key length
+  if (!only || !strcmp(only, "fasthash64"))
+    report("fasthash64", "mixed", mixed_len, measure_mixed(run_mixed_loop));
+  if (!only || !strcmp(only, "fasthash64_batch")) {
+    char name[64];
+    snprintf(name, sizeof(name), "fasthash64_batch/%s",
+             fasthash_kernel_name());
+    report(name, "mixed", mixed_len, measure_mixed(run_mixed_batch));
+  }
+
+  return 0;
+}
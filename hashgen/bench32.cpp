@@ -0,0 +1,69 @@
+/* The MIT License
+
+   Copyright (C) 2024 Reini Urban (reini.urban@gmail.com)
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without
+   restriction, including without limitation the rights to use, copy,
+   modify, merge, publish, distribute, sublicense, and/or sell copies
+   of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+// fasthash32_native against the folded fasthash32. Build with
+// "make bench32" for a 32-bit target, where fasthash32 has to emulate
+// its 64x64 multiplies.
+
+#include "../fasthash.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <ulib/rand_tpl.h>
+#include <ulib/rdtsc.h>
+
+#define ROUNDS 100000
+
+static unsigned char g_buf[1024];
+
+static void run(const char *name, uint32_t (*f)(const void *, size_t, uint32_t),
+                size_t len) {
+  uint32_t h = 0;
+  uint64_t start, cycles;
+
+  start = rdtsc();
+  for (int r = 0; r < ROUNDS; ++r)
+    h = f(g_buf, len, h);
+  cycles = rdtsc() - start;
+
+  printf("%-18s len %4u: %8.2f cycles/hash  (%08x)\n", name, (unsigned)len,
+         (double)cycles / ROUNDS, (unsigned)h);
+}
+
+int main() {
+  static const size_t lens[] = {4, 8, 16, 32, 64, 256, 1024};
+  uint64_t u, v, w;
+
+  RAND_NR_INIT(u, v, w, 0x5eed);
+  for (size_t i = 0; i < sizeof(g_buf); ++i)
+    g_buf[i] = (unsigned char)RAND_NR_NEXT(u, v, w);
+
+  printf("%d-bit build\n", (int)sizeof(void *) * 8);
+  for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); ++i) {
+    run("fasthash32", fasthash32, lens[i]);
+    run("fasthash32_native", fasthash32_native, lens[i]);
+  }
+
+  return 0;
+}
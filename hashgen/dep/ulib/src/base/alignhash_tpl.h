@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "common.h"
+#include "fasthash.h"
 
 #ifdef AH_64BIT  /* specify if you are handling >4G keys */
 
@@ -308,6 +309,17 @@ enum {
  */
 #define alignhash_hashfn(key) (ah_size_t)(key)
 
+/**
+ * alignhash_secretfn - keyed hash function for untrusted keys
+ * NOTE: mixes the key with the per-process secret of
+ * fasthash64_secret(), so colliding keys cannot be precomputed
+ */
+#define alignhash_secretfn(key)						\
+	({								\
+		uint64_t __k = (uint64_t)(key);				\
+		(ah_size_t)fasthash64_secret(&__k, sizeof(__k), 0);	\
+	})
+
 /**
  * alignhash_equalfn - naive equality test function
  */
@@ -98,10 +98,22 @@ chainhash_create(uint32_t minsize,
 	h->entrycount = 0;
 	h->hashfn = hashf;
 	h->eqfn = eqfn;
+	h->keyed = 0;
 	h->loadlimit = (uint32_t) ceil(size * max_load_factor);
 	return h;
 }
 
+struct chainhash *
+chainhash_create_keyed(uint32_t minsize,
+		       uint32_t (*hashf) (void *),
+		       int (*eqfn) (void *, void *))
+{
+	struct chainhash *h = chainhash_create(minsize, hashf, eqfn);
+	if (h)
+		h->keyed = 1;
+	return h;
+}
+
 int chainhash_expand(struct chainhash *h)
 {
 	/* Double the size of the table to accomodate more entries */
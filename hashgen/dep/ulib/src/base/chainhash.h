@@ -84,6 +84,7 @@
 #define __ULIB_CHAINHASH_H
 
 #include <stdint.h>
+#include "fasthash.h"
 
 struct entry
 {
@@ -100,6 +101,7 @@ struct chainhash {
 	uint32_t primeindex;
 	uint32_t (*hashfn) (void *k);
 	int (*eqfn) (void *k1, void *k2);
+	int keyed;
 };
 
 /* This struct is only concrete here to allow the inlining of two of the
@@ -126,6 +128,10 @@ extern "C" {
 		/* Aim to protect against poor hash functions by adding logic here
 		 * - logic taken from java 1.4 chainhash source */
 		uint32_t i = h->hashfn(k);
+		if (h->keyed) {
+			uint64_t x = i;
+			i = (uint32_t)fasthash64_secret(&x, sizeof(x), 0);
+		}
 		/*
 		  i += ~(i << 9);
 		  i ^=  ((i >> 14) | (i << 18));
@@ -146,6 +152,28 @@ extern "C" {
 	chainhash_create(uint32_t minsize,
 			 uint32_t (*hashfn) (void*),
 			      int (*eqfn) (void*, void*));
+
+	/* chainhash_create_keyed
+	 * @name                    chainhash_create_keyed
+	 * @param   minsize         minimum initial size of chainhash
+	 * @param   hashfn          function for hashing keys
+	 * @param   key_eq_fn       function for determining key equality
+	 * @return                  newly created chainhash or NULL on failure
+	 *
+	 * Same as chainhash_create, but rehashes the values of hashfn with
+	 * fasthash64_secret, so keys that are known to collide in one
+	 * bucket no longer do. Use it for keys from untrusted sources.
+	 *
+	 * NOTE: only the 32-bit value of hashfn is keyed, the key itself
+	 * is never seen. Keys with equal hashfn values still share a
+	 * bucket, so this protects against floods only if such keys cannot
+	 * be found, e.g. when hashfn is injective (integer keys) or keyed
+	 * itself (fasthash64_secret over the key bytes).
+	 */
+	struct chainhash *
+	chainhash_create_keyed(uint32_t minsize,
+			       uint32_t (*hashfn) (void*),
+			       int (*eqfn) (void*, void*));
 	
 	/* chainhash_insert
 	 * @name        chainhash_insert
@@ -27,45 +27,9 @@
 #include "rand_tpl.h"
 #include "hash.h"
 
-uint64_t hash_fast64(const void *buf, size_t len, uint64_t seed)
+uint64_t (hash_fast64)(const void *buf, size_t len, uint64_t seed)
 {
-	const uint64_t    m = 0x880355f21e6d1965ULL;
-	const uint64_t *pos = (const uint64_t *)buf;
-	const uint64_t *end = pos + (len >> 3);
-	const unsigned char *pc;
-	uint64_t h = len * m ^ seed;
-	uint64_t v;
-
-	while (pos != end) {
-		v  = *pos++;
-		v ^= v >> 23;
-		v *= 0x2127599bf4325c37ULL;
-		h ^= v ^ (v >> 47);
-		h *= m;
-	}
-
-	pc = (const unsigned char*)pos;
-	v = 0;
-
-	switch (len & 7) {
-	case 7: v ^= (uint64_t)pc[6] << 48; /* fall through */
-	case 6: v ^= (uint64_t)pc[5] << 40; /* fall through */
-	case 5: v ^= (uint64_t)pc[4] << 32; /* fall through */
-	case 4: v ^= (uint64_t)pc[3] << 24; /* fall through */
-	case 3: v ^= (uint64_t)pc[2] << 16; /* fall through */
-	case 2: v ^= (uint64_t)pc[1] << 8; /* fall through */
-	case 1: v ^= (uint64_t)pc[0]; /* fall through */
-		v ^= v >> 23;
-		v *= 0x2127599bf4325c37ULL;
-		h ^= v ^ (v >> 47);
-		h *= m;
-	}
-
-	h ^= h >> 23;
-	h *= 0x2127599bf4325c37ULL;
-	h ^= h >> 47;
-
-	return h;
+	return fasthash64(buf, len, seed);
 }
 
 /*
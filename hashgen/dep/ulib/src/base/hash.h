@@ -28,18 +28,48 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+#include "fasthash.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * hash_fast64 - 64-bit implementation of fasthash, 
+ * hash_fast64 - 64-bit implementation of fasthash, same as fasthash64()
  * @buf:  data buffer
  * @len:  data size
  * @seed: the seed
+ *
+ * Forwards to the fasthash.c kernels, so ulib containers get the same
+ * code and results. Calls go through the inline __hash_fast64(), which
+ * inlines constant 4, 8 and 16 byte lengths; the exported symbol stays
+ * in libubase for existing objects and for taking its address.
  */
-	uint64_t hash_fast64(const void *buf, size_t len, uint64_t seed);
+	uint64_t (hash_fast64)(const void *buf, size_t len, uint64_t seed);
+
+	static inline uint64_t __hash_fast64(const void *buf, size_t len, uint64_t seed)
+	{
+		if (__builtin_constant_p(len)) {
+			uint64_t k[2];
+			uint32_t k32;
+
+			switch (len) {
+			case 4:
+				memcpy(&k32, buf, 4);
+				return fasthash64_u32(k32, seed);
+			case 8:
+				memcpy(k, buf, 8);
+				return fasthash64_u64(k[0], seed);
+			case 16:
+				memcpy(k, buf, 16);
+				return fasthash64_u128(k[0], k[1], seed);
+			}
+		}
+		return fasthash64(buf, len, seed);
+	}
+
+#define hash_fast64(buf, len, seed) __hash_fast64(buf, len, seed)
 
 /**
  * hash_jenkins - implementation of Jenkins hash
@@ -49,7 +49,9 @@
   addressing if AH_64BIT is set. Enabling the flag could improve the
   performance of aligned hashing on 64-bit OSes. Furthermore, enabling
   AH_TIER_PROBING will tell aligned hashing to use double hashing
-  probing, which is preferable for small hash_maps/sets.
+  probing, which is preferable for small hash_maps/sets. For keys from
+  untrusted sources, AH_SECRET_HASH hashes them with
+  fasthash64_secret(), which defeats precomputed collision floods.
 */
 
 #ifndef _ALIGN_HASH_H
@@ -63,8 +65,15 @@
 #define AH_64BIT
 #endif
 //#define AH_TIER_PROBING
+//#define AH_SECRET_HASH
 #include "alignhash_tpl.h"
 
+#ifdef AH_SECRET_HASH
+#define AH_HASHFN alignhash_secretfn
+#else
+#define AH_HASHFN alignhash_hashfn
+#endif
+
 namespace ulib {
 
 struct align_hash_exception : public std::exception
@@ -77,7 +86,7 @@ template<class _Key, class _Val, class _Except = align_hash_exception>
 class align_hash_map
 {
 public:
-	DEFINE_ALIGNHASH(inclass, _Key, _Val, 1, alignhash_hashfn, alignhash_equalfn);
+	DEFINE_ALIGNHASH(inclass, _Key, _Val, 1, AH_HASHFN, alignhash_equalfn);
 
 	typedef ah_iter_t   size_type;
 	typedef _Val *      pointer;
@@ -337,7 +346,7 @@ template<class _Key, class _Except = align_hash_exception>
 class align_hash_set
 {
 public:
-	DEFINE_ALIGNHASH(inclass, _Key, int, 0, alignhash_hashfn, alignhash_equalfn);
+	DEFINE_ALIGNHASH(inclass, _Key, int, 0, AH_HASHFN, alignhash_equalfn);
 
 	typedef ah_iter_t size_type;
 	typedef ah_iter_t hashing_iterator;
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <assert.h>
+#include <algorithm>
 #include <ctime>
 #include <string.h>
 #include <ulib/hash.h>
@@ -21,6 +22,71 @@ struct str {
 	{ return strcmp(c_str, other.c_str) == 0; }
 };
 
+DEFINE_ALIGNHASH(plain, uint64_t, int, 0, alignhash_hashfn, alignhash_equalfn)
+DEFINE_ALIGNHASH(keyed, uint64_t, int, 0, alignhash_secretfn, alignhash_equalfn)
+
+// largest number of the n hashes in h that share a home bucket under
+// mask, and the number of home buckets in use
+static int home_load(ah_size_t *h, int n, ah_size_t mask, int *used)
+{
+	int i, run = 1, max = 1;
+
+	for (i = 0; i < n; ++i)
+		h[i] &= mask;
+	std::sort(h, h + n);
+	*used = 1;
+	for (i = 1; i < n; ++i) {
+		if (h[i] == h[i - 1]) {
+			if (++run > max)
+				max = run;
+		} else {
+			run = 1;
+			++*used;
+		}
+	}
+	return max;
+}
+
+// Keys that differ only above bit 20 share one home bucket of a plain
+// table, so each probe sequence runs through all of them. The secret
+// hash was not part of building the key set; the keys must spread like
+// random ones: 256 keys in 1024 buckets use about 226, with at most a
+// handful per bucket.
+static void test_flood()
+{
+	const int n = 256;
+	alignhash_t(plain) *hp = alignhash_init(plain);
+	alignhash_t(keyed) *hk = alignhash_init(keyed);
+	ah_size_t h[n];
+	int i, ret, used;
+
+	for (i = 0; i < n; ++i) {
+		uint64_t k = (uint64_t)i << 20;
+		alignhash_set(plain, hp, k, &ret);
+		assert(ret == AH_INS_NEW);
+		alignhash_set(keyed, hk, k, &ret);
+		assert(ret == AH_INS_NEW);
+	}
+	assert(alignhash_nbucket(hp) == alignhash_nbucket(hk));
+	assert(alignhash_nbucket(hp) >= 512);
+
+	for (i = 0; i < n; ++i)
+		h[i] = alignhash_hashfn((uint64_t)i << 20);
+	assert(home_load(h, n, alignhash_nbucket(hp) - 1, &used) == n);
+	assert(used == 1);
+
+	for (i = 0; i < n; ++i)
+		h[i] = alignhash_secretfn((uint64_t)i << 20);
+	assert(home_load(h, n, alignhash_nbucket(hk) - 1, &used) < 8);
+	assert(used > n * 3 / 4);
+
+	for (i = 0; i < n; ++i)
+		assert(alignhash_get(keyed, hk, (uint64_t)i << 20) !=
+		       alignhash_end(hk));
+	alignhash_destroy(plain, hp);
+	alignhash_destroy(keyed, hk);
+}
+
 int main()
 {
 	align_hash_map<str, int> months;
@@ -97,6 +163,8 @@ int main()
 		assert(map[num] == 0); // default value for new elemnets is zero
 	}
 
+	test_flood();
+
 	printf("passed\n");
 
 	return 0;
@@ -0,0 +1,165 @@
+/* The MIT License
+
+   Copyright (C) 2024 Reini Urban (reini.urban@gmail.com)
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without
+   restriction, including without limitation the rights to use, copy,
+   modify, merge, publish, distribute, sublicense, and/or sell copies
+   of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+// fasthashsum - print fasthash64_tree digests of files, md5sum style
+
+#include "tree_hash.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// reads all of fd into a malloc()ed buffer, for pipes, FIFOs and
+// devices, whose size is unknown up front; sets errno on failure
+static int read_all(int fd, unsigned char **out, size_t *len) {
+  size_t cap = 1 << 16, n = 0;
+  unsigned char *buf = (unsigned char *)malloc(cap);
+
+  if (buf == NULL)
+    return -1;
+  for (;;) {
+    ssize_t r;
+    if (n == cap) {
+      unsigned char *p = (unsigned char *)realloc(buf, cap * 2);
+      if (p == NULL) {
+        free(buf);
+        return -1;
+      }
+      buf = p;
+      cap *= 2;
+    }
+    r = read(fd, buf + n, cap - n);
+    if (r < 0) {
+      if (errno == EINTR)
+        continue;
+      free(buf);
+      return -1;
+    }
+    if (r == 0)
+      break;
+    n += r;
+  }
+  *out = buf;
+  *len = n;
+  return 0;
+}
+
+// regular files are mapped, anything else is read to the end first
+static int hash_file(const char *path, uint64_t seed, int nthreads,
+                     uint64_t *hash) {
+  struct stat st;
+  void *buf = NULL;
+  int fd = open(path, O_RDONLY);
+
+  if (fd < 0)
+    return -1;
+  if (fstat(fd, &st)) {
+    close(fd);
+    return -1;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    close(fd);
+    errno = EISDIR;
+    return -1;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    unsigned char *data;
+    size_t len;
+    int err;
+    if (read_all(fd, &data, &len)) {
+      err = errno;
+      close(fd);
+      errno = err;
+      return -1;
+    }
+    *hash = tree_hash(data, len, seed, nthreads);
+    free(data);
+    close(fd);
+    return 0;
+  }
+  if (st.st_size) {
+    buf = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (buf == MAP_FAILED) {
+      close(fd);
+      return -1;
+    }
+    madvise(buf, st.st_size, MADV_SEQUENTIAL);
+  }
+  *hash = tree_hash(buf, st.st_size, seed, nthreads);
+  if (buf)
+    munmap(buf, st.st_size);
+  close(fd);
+  return 0;
+}
+
+static void usage(const char *prog) {
+  fprintf(stderr,
+          "usage: %s [-j threads] [-s seed] file...\n"
+          "Prints the fasthash64 tree mode digest of each file.\n",
+          prog);
+}
+
+int main(int argc, char *argv[]) {
+  uint64_t seed = 0;
+  int nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+  int ret = 0;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "j:s:h")) != -1) {
+    switch (opt) {
+    case 'j':
+      nthreads = atoi(optarg);
+      break;
+    case 's':
+      seed = strtoull(optarg, NULL, 0);
+      break;
+    default:
+      usage(argv[0]);
+      return opt == 'h' ? 0 : 1;
+    }
+  }
+  if (nthreads < 1)
+    nthreads = 1;
+  if (optind == argc) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  for (int i = optind; i < argc; ++i) {
+    uint64_t hash;
+    if (hash_file(argv[i], seed, nthreads, &hash)) {
+      fprintf(stderr, "%s: %s: %s\n", argv[0], argv[i], strerror(errno));
+      ret = 1;
+      continue;
+    }
+    printf("%016llx  %s\n", (unsigned long long)hash, argv[i]);
+  }
+
+  return ret;
+}
@@ -25,7 +25,10 @@
    SOFTWARE.
 */
 
+#include <algorithm>
 #include <cstring>
+#include <list>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -34,13 +37,19 @@
 #include "xxhash.h"
 #include <assert.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <math.h>
+#include <sys/mman.h>
 #include <time.h>
+#include <unistd.h>
+#include <ulib/alignhash.h>
 #include <ulib/common.h>
 #include <ulib/console.h>
 #include <ulib/hash.h>
 #include <ulib/log.h>
+#include <ulib/periodic.h>
 #include <ulib/rand_tpl.h>
 #include <ulib/rdtsc.h>
 #include <ulib/thread.h>
@@ -54,6 +63,7 @@
     (a) ^= F(b);                                                               \
     swap(a, b);                                                                \
   })
+#define ROR32(x, r) ((x) >> (r) | (x) << (32 - (r)))
 #define ARR_SIZE(x) sizeof(x)/sizeof(x[0])
 #define RAND_PICK(arr,_u,_v,_w) arr[RAND_NR_NEXT(_u, _v, _w) % ARR_SIZE(arr)]
 
@@ -63,7 +73,54 @@ using namespace ulib;
 int volatile g_aval_len = 47;
 int volatile g_aval_times = 5000;
 float volatile g_time_r = 1;
+// word size of the generated function: 64, or 32 for functions that
+// only need 32-bit multiplies, for targets like fasthash32_native's
+int volatile g_width = 64;
+// lanes of the block step being searched, 0 searches the finalizer
+int volatile g_absorb = 0;
 #define BUF_SIZE 32
+// the fitness cache starts over beyond this many entries
+#define CACHE_MAX (1 << 20)
+// default seconds between checkpoints
+#define CKPT_INTERVAL 600
+// longest sequence a checkpoint may hold
+#define CKPT_MAX_SEQ 64
+// most search threads, and sequences per thread, a checkpoint may hold
+#define CKPT_MAX_THREADS 4096
+#define CKPT_MAX_SEQS 65536
+// most entries kept in the Pareto archive
+#define PARETO_MAX 512
+// timing phase: hashes per run, runs per mode, fixed inputs, and the
+// cycles per hash that cost a time score of g_time_r
+#define TIME_RUNS 4000
+#define TIME_REPEATS 9
+#define TIME_INPUTS 8
+#define TIME_BUF 256
+#define TIME_UNIT 50.0f
+// block steps are timed on inputs this long, at a time score of
+// g_time_r per cycle per byte
+#define TIME_LONG 1024
+// most lanes of a block step
+#define ABSORB_MAX 4
+// longest avalanche input: its 8 * 64 floats of bias per byte live on
+// the stack of the search threads
+#define AVAL_MAX 256
+// most avalanche samples per input bit
+#define AVAL_TIMES_MAX 1000000
+
+// the same pseudo-random inputs for every timed candidate
+static struct time_inputs {
+  uint64_t buf[TIME_INPUTS][TIME_LONG / 8];
+
+  time_inputs() {
+    uint64_t u, v, w;
+
+    RAND_NR_INIT(u, v, w, 2012);
+    for (int i = 0; i < TIME_INPUTS; ++i)
+      for (int j = 0; j < TIME_LONG / 8; ++j)
+        buf[i][j] = RAND_NR_NEXT(u, v, w);
+  }
+} g_time_inputs;
 
 // see also https://github.com/skeeto/hash-prospector
 // which is optimized for 32bit and adds a bias score.
@@ -88,135 +145,131 @@ public:
     OP_NUM       // number of operations
   };
 
-  struct op {
-    op_type type;
-    uint64_t arg;
-    hashgen *gen;
-
-    class arg_mutate : public thread {
-    public:
-      arg_mutate(op *p) : _op(p) {
-        uint64_t now = rdtsc();
-        RAND_NR_INIT(_u, _v, _w, now);
-      }
-
-      ~arg_mutate() { stop_and_join(); }
-
-      int run() {
-        while (is_running()) {
-          uint64_t old = _op->arg;
-          if (_op->type == OP_MUL) {
-            // some known good mult constants from other hashes
-            const uint64_t mul_constants[6] = {
-              UINT64_C(0x2127599bf4325c37),
-              UINT64_C(0xbf58476d1ce4e5b9),
-              UINT64_C(0x94d049bb133111eb),
-              UINT64_C(0x9743d1e18d4481c7),
-              UINT64_C(0xe4adbc73edb87283),
-              UINT64_C(0xff51afd7ed558ccd)
-            };
-            // pick from some changed fixed constants
-            do {
-              _op->arg = RAND_PICK(mul_constants, _u, _v, _w);
-            } while (_op->arg == old);  
-          }
-          else {
-            _op->update(RAND_NR_NEXT(_u, _v, _w));
-          }
-          if (!_op->gen->evolve()) {
-            ULIB_DEBUG("attempt to evolve with arg:%016llx -> %016llx was "
-                       "cancelled",
-                       (unsigned long long)old, (unsigned long long)_op->arg);
-            _op->arg = old;
-          } else {
-            ULIB_DEBUG("arg optimized: %016llx -> %016llx",
-                       (unsigned long long)old, (unsigned long long)_op->arg);
-          }
-        }
-        return 0;
-      }
-
-    private:
-      op *_op;
-      uint64_t _u, _v, _w;
-    } * ctrl;
-
-    void update(uint64_t v) {
-      switch (type) {
-      case OP_ADD: // by 0 makes not much sense
-      case OP_SUB:
-      case OP_XQO:
-        v = v ? v : 1;
-        break;
-      case OP_XSL: // limited to 64 bits
-      case OP_XSR:
-      case OP_ROR:
-      case OP_XOR:
-      case OP_ASL:
-      case OP_SSL:
-      case OP_LOR:
-        v = v % 63 + 1;
-        break;
-      case OP_MUL: // ignored, picked from constants
-      case OP_NOT: // no args
-      case OP_SWP:
-        break;
-      case OP_NUM:
-        ULIB_FATAL("unknown op_type: %d", type);
-      }
-      arg = v;
+  typedef pair<op_type, uint64_t> op;
+  typedef vector<op> op_seq;
+
+  // fitness of a candidate, lower is better
+  struct fitness {
+    float aval; // avalanche and independence score
+    float time; // weighted speed score
+    bool early; // aborted early, aval is a lower bound
+    float bias;   // largest |p - 0.5| of the avalanche matrix
+    float cycles; // latency in cycles per hash of time_len() inputs
+    float tput;   // cycles per hash of independent inputs
+    float overall() const { return aval + time; }
+
+    // no worse in avalanche score, bias and cycles, better in one
+    bool dominates(const fitness &o) const {
+      return aval <= o.aval && bias <= o.bias && cycles <= o.cycles &&
+             (aval < o.aval || bias < o.bias || cycles < o.cycles);
     }
+  };
 
-    void start() {
-      if (ctrl)
-        ctrl->start();
+  // key of the fitness cache: the 128-bit fasthash of a canonical
+  // encoding of the sequence, one type byte per op followed by the
+  // argument bytes that matter. alignhash moves keys with realloc(), so
+  // the key stays plain old data.
+  struct seq_key {
+    uint64_t h[2];
+
+    seq_key() { h[0] = h[1] = 0; }
+
+    explicit seq_key(const op_seq &seq) {
+      int bytes = g_width / 8;
+      string enc;
+
+      enc.reserve(seq.size() * (1 + bytes));
+      for (op_seq::const_iterator it = seq.begin(); it != seq.end(); ++it) {
+        uint64_t arg = it->second;
+        enc += (char)it->first;
+        if (it->first == OP_NOT || it->first == OP_SWP)
+          continue; // no argument
+        for (int i = 0; i < bytes; ++i, arg >>= 8)
+          enc += (char)arg;
+      }
+      fasthash128(enc.data(), enc.size(), 0, h);
     }
 
-    void stop_and_join() {
-      if (ctrl)
-        ctrl->stop_and_join();
-    }
+    operator size_t() const { return h[0]; }
 
-    op(op_type t, hashgen *g) : type(t), gen(g) {
-      uint64_t now = rdtsc();
-      update(RAND_INT4_MIX64(now));
-      ctrl = new arg_mutate(this);
+    bool operator==(const seq_key &other) const {
+      return h[0] == other.h[0] && h[1] == other.h[1];
     }
-
-    ~op() { delete ctrl; }
   };
 
+  // a sequence together with its fitness
+  typedef pair<op_seq, fitness> scored;
+
   hashgen()
       : _min_seq(2), _max_seq(6), // murmur has 5, rrmxmx has 6
-        _best_seen_score(-1)      // negative value for uninitialized
+        _nworkers(sysconf(_SC_NPROCESSORS_ONLN)),
+        _strategy(new_strategy("greedy")), _pop_size(16), _migrate(50),
+        _temp(0.5), _cooling(0.99), _swap(10), _ckpt_task(0),
+        _best_seen_score(-1), // negative value for uninitialized
+        _evals(0), _aborts(0), _updates(0), _hits(0),
+        _misses(0), _cache_gen(0)
   {
     pthread_mutex_init(&_mutex, NULL);
-    ctrl_add_op = new thread_add_op(this);
-    ctrl_del_op = new thread_del_op(this);
-    ctrl_mod_op = new thread_mod_op(this);
-    ctrl_swap_op = new thread_swap_op(this);
+    pthread_mutex_init(&_ckpt_mutex, NULL);
   }
 
   ~hashgen() {
-    delete ctrl_add_op;
-    delete ctrl_del_op;
-    delete ctrl_mod_op;
-    delete ctrl_swap_op;
-    for (vector<op *>::iterator it = _op_seq.begin(); it != _op_seq.end(); ++it)
-      (*it)->stop_and_join();
-    for (vector<op *>::iterator it = _op_seq.begin(); it != _op_seq.end(); ++it)
-      delete (*it);
+    _timer.stop_and_join();
+    stop();
+    delete _strategy;
+    pthread_mutex_destroy(&_ckpt_mutex);
     pthread_mutex_destroy(&_mutex);
   }
 
+  // scores the starting point on first use, then runs one thread per
+  // worker as the strategy sees fit
   int start() {
-    ctrl_add_op->start();
-    ctrl_del_op->start();
-    ctrl_mod_op->start();
-    ctrl_swap_op->start();
+    pthread_mutex_lock(&_ckpt_mutex);
+    lock();
+    if (!_workers.empty()) {
+      unlock();
+      pthread_mutex_unlock(&_ckpt_mutex);
+      return 0;
+    }
+    if (unlikely(_best_seen_score < 0))
+      _init_best_seen();
+    timer_start(&_started);
+    _strategy->prepare(this, _nworkers);
+    for (int i = 0; i < _nworkers; ++i) {
+      searcher *w = _strategy->spawn(this, rdtsc() + i, i);
+      if ((size_t)i < _resume.size())
+        w->restore(_resume[i]);
+      _workers.push_back(w);
+      w->start();
+    }
+    _resume.clear();
+    unlock();
+    pthread_mutex_unlock(&_ckpt_mutex);
     return 0;
   }
 
+  void stop() {
+    pthread_mutex_lock(&_ckpt_mutex);
+    for (vector<searcher *>::iterator it = _workers.begin();
+         it != _workers.end(); ++it)
+      delete *it;
+    _workers.clear();
+    _strategy->release();
+    pthread_mutex_unlock(&_ckpt_mutex);
+  }
+
+  // blocks while the workers run, or for at most secs seconds if secs
+  // is positive; the workers keep running
+  void wait(int secs = 0) {
+    if (secs > 0) {
+      sleep(secs);
+      return;
+    }
+    for (vector<searcher *>::iterator it = _workers.begin();
+         it != _workers.end(); ++it)
+      (*it)->join();
+  }
+
   void lock() { pthread_mutex_lock(&_mutex); }
 
   void unlock() { pthread_mutex_unlock(&_mutex); }
@@ -225,12 +278,143 @@ public:
 
   int get_max_seq() const { return _max_seq; }
 
-  void set_min_seq(int min) { _min_seq = min; }
+  // min_seq is at least 1 and at most max_seq, which is at most
+  // CKPT_MAX_SEQ, so every sequence fits in a checkpoint
+  int set_min_seq(int min) {
+    if (min < 1 || min > _max_seq)
+      return -1;
+    _min_seq = min;
+    return 0;
+  }
+
+  int set_max_seq(int max) {
+    if (max < _min_seq || max > CKPT_MAX_SEQ)
+      return -1;
+    _max_seq = max;
+    return 0;
+  }
+
+  // is value in range for the parameter name? Shared by the console
+  // and checkpoints, so a search never writes what it cannot resume.
+  static int check_param(const char *name, const char *value) {
+    char *end;
+    double d = strtod(value, &end);
+
+    if (!*value || *end || !isfinite(d))
+      return -1;
+    if (!strcmp(name, "width"))
+      return d == 32 || d == 64 ? 0 : -1;
+    if (!strcmp(name, "absorb"))
+      return d == 0 || d == 1 || d == 2 || d == 4 ? 0 : -1;
+    if (!strcmp(name, "temp"))
+      return d > 0 && isfinite((float)d) ? 0 : -1;
+    if (!strcmp(name, "cooling"))
+      return d > 0 && d < 1 ? 0 : -1;
+    if (!strcmp(name, "aval_rate") || !strcmp(name, "indep_rate") ||
+        !strcmp(name, "time_rate") || !strcmp(name, "aval_conf"))
+      return d >= 0 && isfinite((float)d) ? 0 : -1;
+    if (d != (int)d)
+      return -1;
+    if (!strcmp(name, "aval_byte"))
+      return d >= 1 && d <= AVAL_MAX ? 0 : -1;
+    if (!strcmp(name, "aval_times"))
+      return d >= 1 && d <= AVAL_TIMES_MAX ? 0 : -1;
+    if (!strcmp(name, "min_seq") || !strcmp(name, "max_seq"))
+      return d >= 1 && d <= CKPT_MAX_SEQ ? 0 : -1;
+    if (!strcmp(name, "workers"))
+      return d >= 1 && d <= CKPT_MAX_THREADS ? 0 : -1;
+    if (!strcmp(name, "population"))
+      return d >= 4 && d <= CKPT_MAX_SEQS ? 0 : -1;
+    if (!strcmp(name, "migrate") || !strcmp(name, "swap"))
+      return d >= 1 ? 0 : -1;
+    return -1;
+  }
+
+  // fails while a search is running. Sequences found at the old width
+  // may shift by more than the new one allows, and their scores do not
+  // compare, so the search starts over from the baseline.
+  int set_width(int w) {
+    lock();
+    if (!_workers.empty()) {
+      unlock();
+      return -1;
+    }
+    if (w != g_width) {
+      g_width = w;
+      _reset_search();
+    }
+    unlock();
+    clear_cache();
+    return 0;
+  }
+
+  // like set_width(): block steps and finalizers score different hash
+  // shapes, so a switch starts over from the baseline of the new mode
+  int set_absorb(int lanes) {
+    lock();
+    if (!_workers.empty()) {
+      unlock();
+      return -1;
+    }
+    if (lanes != g_absorb) {
+      g_absorb = lanes;
+      _reset_search();
+    }
+    unlock();
+    clear_cache();
+    return 0;
+  }
+
+  int get_workers() const { return _nworkers; }
 
-  void set_max_seq(int max) { _max_seq = max; }
+  void set_workers(int n) { _nworkers = n > 0 ? n : 1; }
+
+  const char *get_strategy() const { return _strategy->name(); }
+
+  // fails for unknown names, and while a search is running
+  int set_strategy(const char *name) {
+    strategy *s;
+
+    lock();
+    if (!_workers.empty() || (s = new_strategy(name)) == NULL) {
+      unlock();
+      return -1;
+    }
+    delete _strategy;
+    _strategy = s;
+    unlock();
+    return 0;
+  }
+
+  int get_pop_size() const { return _pop_size; }
+
+  // tournaments need a few members to choose from
+  void set_pop_size(int n) { _pop_size = n > 4 ? n : 4; }
+
+  int get_migrate() const { return _migrate; }
+
+  void set_migrate(int n) { _migrate = n > 0 ? n : 1; }
+
+  float get_temp() const { return _temp; }
+
+  // the acceptance test divides by the temperature
+  int set_temp(float t) {
+    if (!isfinite(t) || t <= 0)
+      return -1;
+    _temp = t;
+    return 0;
+  }
+
+  float get_cooling() const { return _cooling; }
+
+  void set_cooling(float c) { _cooling = c > 0 && c < 1 ? c : 0.99; }
+
+  int get_swap() const { return _swap; }
+
+  void set_swap(int n) { _swap = n > 0 ? n : 1; }
 
   // may these ops be adjacent?
-  int adjacent(enum op_type a, enum op_type b) {
+  static int adjacent(enum op_type a, enum op_type b) {
     switch (a) {
     case OP_XQO:
     case OP_LOR:
@@ -253,176 +437,612 @@ public:
     return 0;
   }
 
-  void add_op(uint64_t rnd) {
-    uint32_t r1 = (uint32_t)(rnd >> 32);
-    uint32_t r2 = (uint32_t)rnd;
-
-    lock();
+  // a random argument for an op of type t, different from old
+  static uint64_t rand_arg(op_type t, uint64_t old, uint64_t &u, uint64_t &v,
+                           uint64_t &w) {
+    // some known good mult constants from other hashes
+    static const uint64_t mul_constants[6] = {
+      UINT64_C(0x2127599bf4325c37),
+      UINT64_C(0xbf58476d1ce4e5b9),
+      UINT64_C(0x94d049bb133111eb),
+      UINT64_C(0x9743d1e18d4481c7),
+      UINT64_C(0xe4adbc73edb87283),
+      UINT64_C(0xff51afd7ed558ccd)
+    };
+    // and from 32-bit hashes: murmur3, lowbias32, xxh32
+    static const uint64_t mul_constants32[6] = {
+      0x85ebca6b, 0xc2b2ae35, 0x7feb352d,
+      0x846ca68b, 0x9e3779b1, 0x27d4eb2f
+    };
+    uint64_t arg;
 
-    if (_op_seq.size() == 0) {
-      op *new_op = new op((op_type)(r2 % (uint32_t)OP_NUM), this);
-      while (new_op->type == OP_ADD) // don't start with the worst op
-        new_op = new op((op_type)(r2 % (uint32_t)OP_NUM), this);
-      _op_seq.push_back(new_op);
-      new_op->start();
-#ifndef UNDEBUG
-      char buf[BUF_SIZE];
-      pair<op_type, uint64_t> it = {new_op->type, new_op->arg};
-      ULIB_DEBUG("new op %s added", _print_op(it, buf));
-#endif
-    } else if (_op_seq.size() < (unsigned)_max_seq) {
-      op *new_op = new op((op_type)(r2 % (uint32_t)OP_NUM), this);
-      uint32_t pos = r1 % (_op_seq.size() + 1);
-      op *next_op = pos < _op_seq.size() ? _op_seq[pos] : _op_seq[0];
-      while (!adjacent(new_op->type, next_op->type)) {
-#ifndef UNDEBUG
-        char buf1[BUF_SIZE];
-        char buf2[BUF_SIZE];
-        pair<op_type, uint64_t> p1 = {new_op->type, new_op->arg};
-        pair<op_type, uint64_t> p2 = {next_op->type, next_op->arg};
-        ULIB_DEBUG("new op %s adjacent to %s cancelled", _print_op(p1, buf1),
-                   _print_op(p2, buf2));
-#endif
-        new_op = new op((op_type)(r2 % (uint32_t)OP_NUM), this);
-        pos = r1 % (_op_seq.size() + 1);
-        next_op = pos < _op_seq.size() ? _op_seq[pos] : _op_seq[0];
-      }
-      // before
-      vector<op *>::iterator it = _op_seq.begin() + pos;
-      _op_seq.insert(it, new_op);
-      if (!_evolve()) {
-#ifndef UNDEBUG
-        char buf[BUF_SIZE];
-        pair<op_type, uint64_t> p = {new_op->type, new_op->arg};
-        ULIB_DEBUG("attempt to add new op %s to pos=%u was"
-                   "cancelled",
-                   _print_op(p, buf), pos);
-#endif
-        _op_seq.erase(it);
-        delete new_op;
-      } else {
-#ifndef UNDEBUG
-        char buf[BUF_SIZE];
-        pair<op_type, uint64_t> p = {new_op->type, new_op->arg};
-        ULIB_DEBUG("new op %s added to pos=%u", _print_op(p, buf), pos);
-#endif
-        new_op->start();
+    do {
+      arg = RAND_NR_NEXT(u, v, w);
+      switch (t) {
+      case OP_ADD: // by 0 makes not much sense
+      case OP_SUB:
+      case OP_XQO:
+        arg = arg ? arg : 1;
+        break;
+      case OP_XSL: // limited to the word size
+      case OP_XSR:
+      case OP_ROR:
+      case OP_XOR:
+      case OP_ASL:
+      case OP_SSL:
+      case OP_LOR:
+        arg = arg % (g_width - 1) + 1;
+        break;
+      case OP_MUL: // pick from some fixed constants
+        if (g_width == 32)
+          arg = RAND_PICK(mul_constants32, u, v, w);
+        else
+          arg = RAND_PICK(mul_constants, u, v, w);
+        break;
+      case OP_NOT: // no args
+      case OP_SWP:
+        return 0;
+      case OP_NUM:
+        ULIB_FATAL("unknown op_type: %d", t);
       }
+    } while (arg == old);
+    return arg;
+  }
+
+  // applies one random add, del, mod, swap or arg mutation to seq.
+  // Returns false if seq was left unchanged.
+  bool mutate(op_seq &seq, uint64_t &u, uint64_t &v, uint64_t &w) {
+    op_seq old = seq;
+    uint64_t r = RAND_NR_NEXT(u, v, w);
+    uint32_t n = seq.size();
+    uint32_t pos = (uint32_t)(r >> 32) % (n ? n : 1);
+
+    switch (r % 5) {
+    case 0: { // add
+      if (n >= (unsigned)_max_seq)
+        return false;
+      op_type t = (op_type)(RAND_NR_NEXT(u, v, w) % OP_NUM);
+      pos = (uint32_t)(r >> 32) % (n + 1);
+      if (n == 0 && t == OP_ADD) // don't start with the worst op
+        return false;
+      if (n && !adjacent(t, seq[pos < n ? pos : 0].first))
+        return false;
+      seq.insert(seq.begin() + pos, op(t, rand_arg(t, 0, u, v, w)));
+      break;
+    }
+    case 1: // del, if the ops around it may meet
+      if (n <= (unsigned)_min_seq || n < 3)
+        return false;
+      if (!adjacent(seq[(pos + n - 1) % n].first, seq[(pos + 1) % n].first))
+        return false;
+      seq.erase(seq.begin() + pos);
+      break;
+    case 2: // mod
+      if (!n)
+        return false;
+      seq[pos].first = (op_type)(RAND_NR_NEXT(u, v, w) % OP_NUM);
+      seq[pos].second = rand_arg(seq[pos].first, 0, u, v, w);
+      break;
+    case 3: // swap
+      if (n < 2)
+        return false;
+      swap(seq[pos], seq[(uint32_t)r % n]);
+      break;
+    case 4: // arg
+      if (!n)
+        return false;
+      seq[pos].second = rand_arg(seq[pos].first, seq[pos].second, u, v, w);
+      break;
     }
 
-    unlock();
+    return seq != old;
   }
 
-  void del_op(uint64_t rnd) {
-    lock();
+  // one-point crossover: a head of a followed by a tail of b; fails if
+  // the child is out of the length limits, repeats a parent, or joins
+  // ops that may not meet
+  bool crossover(const op_seq &a, const op_seq &b, op_seq &child,
+                 uint64_t &u, uint64_t &v, uint64_t &w) {
+    uint32_t i = RAND_NR_NEXT(u, v, w) % (a.size() + 1);
+    uint32_t j = RAND_NR_NEXT(u, v, w) % (b.size() + 1);
+    size_t n = i + b.size() - j;
+
+    if (n < (unsigned)_min_seq || n > (unsigned)_max_seq)
+      return false;
+    if (i && j < b.size() && !adjacent(a[i - 1].first, b[j].first))
+      return false;
+    child.assign(a.begin(), a.begin() + i);
+    child.insert(child.end(), b.begin() + j, b.end());
+    return child != a && child != b;
+  }
 
-    if (_op_seq.size() > (unsigned)_max_seq) {
-      uint32_t pos = rnd % _op_seq.size();
-      op *tmp = _op_seq[pos];
-      op *tmp1 = pos < _op_seq.size() - 1 ? _op_seq[pos + 1] : _op_seq[0];
-      while (!adjacent(tmp->type, tmp1->type)) {
-#ifndef UNDEBUG
-        char buf1[BUF_SIZE];
-        char buf2[BUF_SIZE];
-        pair<op_type, uint64_t> p1 = {tmp->type, tmp->arg};
-        pair<op_type, uint64_t> p2 = {tmp1->type, tmp1->arg};
-        ULIB_DEBUG("new op %s adjacent to %s cancelled", _print_op(p1, buf1),
-                   _print_op(p2, buf2));
+  // An op sequence compiled once to native code, so that scoring runs
+  // the candidate itself rather than the _process() interpreter. The
+  // x86-64 JIT writes into private pages that are never writable and
+  // executable at the same time. Elsewhere, or if the pages cannot be
+  // mapped, calls fall back to the interpreter. While a block step is
+  // searched, the loop over whole blocks is compiled as well, with the
+  // lanes kept in registers.
+  //
+  // The gain is mostly in what time_hash() measures: on the fasthash
+  // mix the interpreter reports 39 cycles per hash against 28 native,
+  // and on a 4-lane block step 2700 against 430, so the time score
+  // would rank op dispatch rather than the ops. Avalanche sampling of
+  // a 4-lane block step takes a quarter less time; for finalizers the
+  // statistics dominate and the sampling time is unchanged.
+  class compiled {
+  public:
+    compiled()
+        : _code(NULL), _n(0), _fn(NULL), _fn32(NULL), _blocks(NULL),
+          _lanes(0), _seq(NULL) {
+#ifdef __x86_64__
+      void *p = mmap(NULL, JIT_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (p != MAP_FAILED)
+        _code = (unsigned char *)p;
 #endif
-        pos = rnd % _op_seq.size();
-        tmp = _op_seq[pos];
+    }
+
+    ~compiled() {
+      if (_code)
+        munmap(_code, JIT_SIZE);
+    }
+
+    // seq must outlive the calls, for the interpreter fallback
+    void compile(const op_seq &seq) {
+      size_t blocks = 0;
+      int lanes = g_absorb;
+
+      _seq = &seq;
+      _fn = NULL;
+      _fn32 = NULL;
+      _blocks = NULL;
+      // the longest op takes 14 bytes, a lane 10 more
+      if (!_code || (seq.size() * 14 + 16) * (lanes + 1) + 32 > JIT_SIZE ||
+          mprotect(_code, JIT_SIZE, PROT_READ | PROT_WRITE))
+        return;
+      _n = 0;
+      _emit(seq, g_width == 64);
+      _lanes = lanes;
+      if (_lanes) {
+        blocks = _n;
+        _emit_blocks(seq, _lanes);
       }
-      _op_seq.erase(_op_seq.begin() + pos);
-      if (!_evolve()) {
-#ifndef UNDEBUG
-        char buf[BUF_SIZE];
-        pair<op_type, uint64_t> it = {tmp->type, tmp->arg};
-        ULIB_DEBUG("attempt to erase op %s at pos=%u was cancelled",
-                   _print_op(it, buf), pos);
-#endif
-        _op_seq.insert(_op_seq.begin() + pos, tmp);
-      } else {
-#ifndef UNDEBUG
-        char buf[BUF_SIZE];
-        pair<op_type, uint64_t> it = {tmp->type, tmp->arg};
-        ULIB_DEBUG("erased op %s at pos=%u", _print_op(it, buf), pos);
-#endif
-        unlock();
-        delete tmp;
+      if (mprotect(_code, JIT_SIZE, PROT_READ | PROT_EXEC))
+        return;
+      if (g_width == 32)
+        _fn32 = (uint32_t(*)(uint32_t))_code;
+      else
+        _fn = (uint64_t(*)(uint64_t))_code;
+      if (blocks)
+        _blocks = (void (*)(uint64_t *, const void *, size_t))(_code + blocks);
+      _verify(seq);
+    }
+
+    uint64_t operator()(uint64_t x) const {
+      return _fn ? _fn(x) : _process(*_seq, x);
+    }
+
+    // absorbs n blocks of lanes words, lane i taking word i of each
+    // block as lane[i] = step(lane[i] + word); n must not be 0
+    void blocks(uint64_t *lane, int lanes, const void *buf, size_t n) const {
+      if (_blocks && lanes == _lanes) {
+        _blocks(lane, buf, n);
         return;
       }
+      _absorb_blocks(*_seq, lane, lanes, buf, n);
     }
 
-    unlock();
+    uint32_t run32(uint32_t x) const {
+      return _fn32 ? _fn32(x) : _process32(*_seq, x);
+    }
+
+  private:
+    enum { JIT_SIZE = 16384 };
+
+    void _b(unsigned char c) { _code[_n++] = c; }
+
+    void _imm(uint64_t v, int bytes) {
+      for (int i = 0; i < bytes; ++i, v >>= 8)
+        _b((unsigned char)v);
+    }
+
+    // REX.W prefix in 64-bit mode
+    void _w(bool w64) {
+      if (w64)
+        _b(0x48);
+    }
+
+    // mov rcx/ecx, imm
+    void _mov_rcx(uint64_t v, bool w64) {
+      _w(w64);
+      _b(0xb9);
+      _imm(v, w64 ? 8 : 4);
+    }
+
+    // op rax, rcx with one of the ALU opcodes below
+    void _alu(unsigned char opc, bool w64) {
+      _w(w64);
+      _b(opc);
+      _b(0xc8);
+    }
+
+    // mov rcx, rax; shift/rotate rcx, n
+    void _copy_shift(unsigned char modrm, uint64_t n, bool w64) {
+      _w(w64);
+      _b(0x89);
+      _b(0xc1);
+      _w(w64);
+      _b(0xc1);
+      _b(modrm);
+      _b((unsigned char)n);
+    }
+
+    // input in rdi/edi, result in rax/eax, clobbers rcx
+    void _emit(const op_seq &seq, bool w64) {
+      _w(w64); // mov rax, rdi
+      _b(0x89);
+      _b(0xf8);
+      _emit_ops(seq, w64);
+      _b(0xc3); // ret
+    }
+
+    // void (uint64_t *lane, const void *buf, size_t n): lane i lives in
+    // r8 + i, buf walks in rsi and n counts down in rdx
+    void _emit_blocks(const op_seq &seq, int lanes) {
+      size_t loop;
+      int i;
+
+      for (i = 0; i < lanes; ++i) { // mov r8+i, [rdi + 8i]
+        _b(0x4c);
+        _b(0x8b);
+        _b(0x47 | i << 3);
+        _b(8 * i);
+      }
+      loop = _n;
+      for (i = 0; i < lanes; ++i) {
+        _b(0x4c); // mov rax, r8+i
+        _b(0x89);
+        _b(0xc0 | i << 3);
+        _b(0x48); // add rax, [rsi + 8i]
+        _b(0x03);
+        _b(0x46);
+        _b(8 * i);
+        _emit_ops(seq, true);
+        _b(0x49); // mov r8+i, rax
+        _b(0x89);
+        _b(0xc0 | i);
+      }
+      _b(0x48); // add rsi, 8 * lanes
+      _b(0x83);
+      _b(0xc6);
+      _b(8 * lanes);
+      _b(0x48); // dec rdx
+      _b(0xff);
+      _b(0xca);
+      _b(0x0f); // jnz loop
+      _b(0x85);
+      _imm((uint32_t)(loop - (_n + 4)), 4);
+      for (i = 0; i < lanes; ++i) { // mov [rdi + 8i], r8+i
+        _b(0x4c);
+        _b(0x89);
+        _b(0x47 | i << 3);
+        _b(8 * i);
+      }
+      _b(0xc3); // ret
+    }
+
+    // the ops of seq on rax/eax, clobbers rcx
+    void _emit_ops(const op_seq &seq, bool w64) {
+      enum { ADD = 0x01, SUB = 0x29, XOR = 0x31 };
+      enum { SHL = 0xe1, SHR = 0xe9, ROR = 0xc9 };
+
+      for (op_seq::const_iterator it = seq.begin(); it != seq.end(); ++it) {
+        uint64_t arg = w64 ? it->second : (uint32_t)it->second;
+        switch (it->first) {
+        case OP_MUL: // imul rax, rcx
+          _mov_rcx(arg, w64);
+          _w(w64);
+          _b(0x0f);
+          _b(0xaf);
+          _b(0xc1);
+          break;
+        case OP_ADD:
+          _mov_rcx(arg, w64);
+          _alu(ADD, w64);
+          break;
+        case OP_SUB:
+          _mov_rcx(arg, w64);
+          _alu(SUB, w64);
+          break;
+        case OP_XOR:
+          _mov_rcx(arg, w64);
+          _alu(XOR, w64);
+          break;
+        case OP_XSL:
+          _copy_shift(SHL, arg, w64);
+          _alu(XOR, w64);
+          break;
+        case OP_XSR:
+          _copy_shift(SHR, arg, w64);
+          _alu(XOR, w64);
+          break;
+        case OP_ROR:
+          _copy_shift(ROR, arg, w64);
+          _alu(XOR, w64);
+          break;
+        case OP_ASL:
+          _copy_shift(SHL, arg, w64);
+          _alu(ADD, w64);
+          break;
+        case OP_SSL:
+          _copy_shift(SHL, arg, w64);
+          _alu(SUB, w64);
+          break;
+        case OP_NOT: // not rax
+          _w(w64);
+          _b(0xf7);
+          _b(0xd0);
+          break;
+        case OP_SWP: // bswap rax
+          _w(w64);
+          _b(0x0f);
+          _b(0xc8);
+          break;
+        case OP_LOR: // shl rax, n
+          _w(w64);
+          _b(0xc1);
+          _b(0xe0);
+          _b((unsigned char)arg);
+          break;
+        case OP_XQO: // mov rax, (n|1)^(n*n)
+          _w(w64);
+          _b(0xb8);
+          if (w64)
+            _imm((arg | 1ull) ^ (arg * arg), 8);
+          else
+            _imm((uint32_t)((arg | 1u) ^ (arg * arg)), 4);
+          break;
+        case OP_NUM:
+          ULIB_FATAL("unknown op type:%d", it->first);
+        }
+      }
+    }
+
+    // cheap guard against encoding mistakes
+    void _verify(const op_seq &seq) {
+      static const uint64_t in[] = {0, 1, 0x0123456789abcdefULL,
+                                    0xfedcba9876543210ULL};
+      for (unsigned i = 0; i < ARR_SIZE(in); ++i) {
+        bool ok = _fn ? _fn(in[i]) == _process(seq, in[i])
+                      : _fn32((uint32_t)in[i]) ==
+                            _process32(seq, (uint32_t)in[i]);
+        if (!ok)
+          ULIB_FATAL("JIT output differs from the interpreter");
+      }
+      if (_blocks) {
+        uint64_t a[ABSORB_MAX], b[ABSORB_MAX], words[2 * ABSORB_MAX];
+        for (int i = 0; i < 2 * ABSORB_MAX; ++i)
+          words[i] = in[i % ARR_SIZE(in)] + i;
+        for (int i = 0; i < ABSORB_MAX; ++i)
+          a[i] = b[i] = in[i];
+        _blocks(a, words, 2);
+        _absorb_blocks(seq, b, _lanes, words, 2);
+        if (memcmp(a, b, sizeof(a)))
+          ULIB_FATAL("JIT block loop differs from the interpreter");
+      }
+    }
+
+    unsigned char *_code;
+    size_t _n;
+    uint64_t (*_fn)(uint64_t);
+    uint32_t (*_fn32)(uint32_t);
+    void (*_blocks)(uint64_t *, const void *, size_t);
+    int _lanes; // of _blocks
+    const op_seq *_seq;
+  };
+
+  // the overall score a greedy candidate has to beat; it only
+  // decreases, so a candidate bounded above it now can never win
+  float best_target() const {
+    return _best_seen_score < 0 ? HUGE_VALF : _best_seen_score;
+  }
+
+  // Cycles per hash of time_len() inputs in latency mode, where each
+  // hash waits for the previous one, and throughput mode, on fixed
+  // inputs. The thread stays on its CPU meanwhile; each mode is warmed
+  // up and the median of TIME_REPEATS runs taken.
+  static void time_hash(avalanche::hash_func_t h, float &cycles,
+                        float &tput) {
+    cpu_set_t old, one;
+    int cpu = sched_getcpu();
+    bool pinned = false;
+
+    if (cpu >= 0 &&
+        !pthread_getaffinity_np(pthread_self(), sizeof(old), &old)) {
+      CPU_ZERO(&one);
+      CPU_SET(cpu, &one);
+      pinned = !pthread_setaffinity_np(pthread_self(), sizeof(one), &one);
+    }
+    cycles = _time_mode(h, true);
+    tput = _time_mode(h, false);
+    if (pinned)
+      pthread_setaffinity_np(pthread_self(), sizeof(old), &old);
+  }
+
+  // block steps are charged per byte, finalizers per hash
+  static float time_score(float cycles, float tput) {
+    float unit = g_absorb ? (float)time_len() : TIME_UNIT;
+    return g_time_r * (cycles + tput) / (2 * unit);
+  }
+
+  static size_t time_len() {
+    if (g_absorb)
+      return TIME_LONG;
+    return g_aval_len < TIME_BUF ? g_aval_len : TIME_BUF;
+  }
+
+  // input length of the avalanche test; a block step is tested on at
+  // least two blocks and a partial word, so that every lane chains and
+  // the tail path runs
+  static int aval_len() {
+    int min = g_absorb * 16 + 7;
+    return g_absorb && g_aval_len < min ? min : g_aval_len;
+  }
+
+  // scores seq on the calling thread, taking the lock only to read the
+  // Pareto archive when target is finite. The time score comes first, then the avalanche test
+  // gives up once the overall score is known to reach target and the
+  // avalanche score that of an archived candidate at most as slow, so
+  // that fast but biased trade-offs still reach the archive.
+  fitness score(const op_seq &seq, avalanche &aval, compiled &fin,
+                float target) {
+    float limit;
+    fitness f;
+
+    fin.compile(seq);
+    _cur = &fin;
+    time_hash(gen_hash, f.cycles, f.tput);
+    f.time = time_score(f.cycles, f.tput);
+    limit = target - f.time;
+    if (limit < HUGE_VALF) { // else no abort, and the lock may be held
+      lock();
+      limit = max(limit, _pareto_bound(f.cycles));
+      unlock();
+    }
+    f.aval = aval(gen_hash, aval_len(), g_aval_times, limit, &f.early);
+    f.bias = f.early ? 0 : aval.bias();
+    _cur = NULL;
+    __sync_fetch_and_add(&_evals, 1);
+    if (f.early)
+      __sync_fetch_and_add(&_aborts, 1);
+    return f;
   }
 
-  void mod_op(uint64_t rnd) {
+  // score() with memoization; repeated sequences become lookups.
+  // Candidates that cannot reach an overall score below target may be
+  // cut short, then f.early is set.
+  fitness evaluate(const op_seq &seq, avalanche &aval, compiled &fin,
+                   float target) {
+    seq_key key(seq);
+    unsigned gen;
+    fitness f;
+
     lock();
+    align_hash_map<seq_key, fitness>::iterator it = _cache.find(key);
+    // a bound from a run cut short may be too weak for this target
+    if (it != _cache.end() &&
+        (!it.value().early || it.value().overall() >= target)) {
+      f = it.value();
+      ++_hits;
+      unlock();
+      return f;
+    }
+    ++_misses;
+    gen = _cache_gen;
+    unlock();
 
-    if (_op_seq.size()) {
-      uint32_t pos = rnd % _op_seq.size();
-      op_type old_type = _op_seq[pos]->type;
-      uint64_t old_arg = _op_seq[pos]->arg;
-      _op_seq[pos]->type = (op_type)(RAND_INT_MIX64(rnd) % (unsigned)OP_NUM);
-      _op_seq[pos]->update(rnd ^ rdtsc());
+    f = score(seq, aval, fin, target);
 
-      if (!_evolve()) {
-#ifndef UNDEBUG
-        char buf[BUF_SIZE];
-        pair<op_type, uint64_t> it = {_op_seq[pos]->type, _op_seq[pos]->arg};
-        ULIB_DEBUG("attempt to mod op %s at pos=%u was cancelled",
-                   _print_op(it, buf), pos);
-#endif
-        _op_seq[pos]->type = old_type;
-        _op_seq[pos]->arg = old_arg;
-      } else {
-#ifndef UNDEBUG
-        char buf[BUF_SIZE];
-        pair<op_type, uint64_t> it = {_op_seq[pos]->type, _op_seq[pos]->arg};
-        ULIB_DEBUG("modified op %s at pos=%u", _print_op(it, buf), pos);
-#endif
-      }
+    lock();
+    // drop results computed with parameters changed in the meantime
+    if (gen == _cache_gen) {
+      if (_cache.size() >= CACHE_MAX)
+        _cache.clear();
+      _cache.insert(key, f, true);
     }
+    unlock();
+    return f;
+  }
 
+  // forgets all cached fitness values, for when the fitness parameters
+  // change
+  void clear_cache() {
+    lock();
+    _cache.clear();
+    ++_cache_gen;
     unlock();
   }
 
-  void swap_op(uint64_t rnd) {
+  void print_cache() {
     lock();
+    _print_cache();
+    unlock();
+  }
 
-    if (_op_seq.size() > 1) {
-      uint32_t pos1 = (rnd >> 32) % _op_seq.size();
-      uint32_t pos2 = (uint32_t)rnd % _op_seq.size();
-      if (pos1 != pos2) {
-        op_type tmp_type = _op_seq[pos1]->type;
-        uint64_t tmp_arg = _op_seq[pos1]->arg;
-        _op_seq[pos1]->type = _op_seq[pos2]->type;
-        _op_seq[pos2]->type = tmp_type;
-        _op_seq[pos1]->arg = _op_seq[pos2]->arg;
-        _op_seq[pos2]->arg = tmp_arg;
-        if (!_evolve()) {
-          ULIB_DEBUG("attempt to swap pos1=%u and pos2=%u was cancelled", pos1,
-                     pos2);
-          tmp_type = _op_seq[pos1]->type;
-          tmp_arg = _op_seq[pos1]->arg;
-          _op_seq[pos1]->type = _op_seq[pos2]->type;
-          _op_seq[pos2]->type = tmp_type;
-          _op_seq[pos1]->arg = _op_seq[pos2]->arg;
-          _op_seq[pos2]->arg = tmp_arg;
-        } else {
-          ULIB_DEBUG("swapped pos1=%u and pos2=%u", pos1, pos2);
-        }
-      }
+  // makes seq the best seen result if it beats it
+  bool publish(const op_seq &seq, const fitness &f) {
+    bool ret = false;
+
+    // an aborted run is known to lose, and to be beaten in avalanche
+    // score by an archived candidate at most as slow
+    if (f.early)
+      return false;
+    lock();
+    _pareto_add(seq, f);
+    if (f.overall() < _best_seen_score) {
+      _best_seen = seq;
+      _best_seen_score = f.overall();
+      ++_updates;
+      printf("Updated best seen score: aval_score=%f, time_score=%f, "
+             "overall=%f\n",
+             f.aval, f.time, _best_seen_score);
+      _print_best_seen();
+      ret = true;
     }
+    unlock();
+    return ret;
+  }
 
+  // Metropolis step at temperature t: a mutant of cur replaces it if
+  // better, or with probability exp(-delta / t) if worse. Candidates
+  // whose chance is below 1/1000 may be cut short.
+  void anneal_step(scored &cur, float t, avalanche &aval, compiled &fin,
+                   uint64_t &u, uint64_t &v, uint64_t &w) {
+    op_seq seq = cur.first;
+    float e = cur.second.overall();
+
+    if (!mutate(seq, u, v, w))
+      return;
+    fitness f = evaluate(seq, aval, fin, e + t * 6.907755f);
+    if (f.early)
+      return;
+    publish(seq, f);
+    if (f.overall() <= e ||
+        uniform(u, v, w) < expf((e - f.overall()) / (t > 0 ? t : 1e-9f)))
+      cur = scored(seq, f);
+  }
+
+  static double uniform(uint64_t &u, uint64_t &v, uint64_t &w) {
+    return (RAND_NR_NEXT(u, v, w) >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  // prints the Pareto archive by increasing cost
+  void print_pareto(FILE *fp) {
+    lock();
+    vector<scored> front = _pareto;
     unlock();
+
+    sort(front.begin(), front.end(), _by_cycles);
+    fprintf(fp, "# cycles/hash  tput      bias      aval_score  sequence\n");
+    for (vector<scored>::iterator it = front.begin(); it != front.end();
+         ++it) {
+      fprintf(fp, "%-13.1f %-9.1f %-9.6f %-11.6f", it->second.cycles,
+              it->second.tput, it->second.bias, it->second.aval);
+      for (op_seq::const_iterator op = it->first.begin();
+           op != it->first.end(); ++op) {
+        char buf[BUF_SIZE];
+        fprintf(fp, " %s", _print_op(*op, buf));
+      }
+      fprintf(fp, "\n");
+    }
   }
 
-  bool evolve() {
+  op_seq best_seen() {
     lock();
-    bool ret = _evolve();
+    op_seq seq = _best_seen;
     unlock();
-    return ret;
+    return seq;
   }
 
   void print_best_seen() {
@@ -431,9 +1051,89 @@ public:
     unlock();
   }
 
+  void print_stats() {
+    lock();
+    float secs = _workers.empty() ? 0 : timer_stop(&_started);
+    printf("workers: %d\n", (int)_workers.size());
+    printf("evaluated: %llu, aborted early: %llu (%.1f%%), improved: %llu\n",
+           (unsigned long long)_evals, (unsigned long long)_aborts,
+           _evals ? 100.0 * _aborts / _evals : 0.0,
+           (unsigned long long)_updates);
+    if (secs > 0)
+      printf("rate: %.1f candidates/s\n", _evals / secs);
+    _print_cache();
+    _strategy->print_stats();
+    unlock();
+  }
+
+  // writes a checkpoint to path now, and then every secs seconds if
+  // secs is positive
+  void set_checkpoint(const char *path, int secs) {
+    pthread_mutex_lock(&_ckpt_mutex);
+    _ckpt_path = path;
+    pthread_mutex_unlock(&_ckpt_mutex);
+    if (_ckpt_task) {
+      _timer.unschedule(_ckpt_task);
+      _ckpt_task = 0;
+    }
+    if (checkpoint())
+      ULIB_WARNING("cannot write checkpoint %s", path);
+    if (secs > 0) {
+      _timer.start(); // does nothing once started
+      _ckpt_task = _timer.schedule_repeated(sec_from_now(secs),
+                                            secs * 1000000L, _on_timer, this);
+    }
+  }
+
+  // Saves the fitness parameters, the best seen result and the state of
+  // every search thread, RNGs included, as text. The file is replaced
+  // atomically, so a crash leaves the previous checkpoint intact.
+  int checkpoint() {
+    int ret = -1;
+
+    pthread_mutex_lock(&_ckpt_mutex);
+    if (!_ckpt_path.empty()) {
+      string tmp = _ckpt_path + ".tmp";
+      FILE *fp = fopen(tmp.c_str(), "w");
+      if (fp) {
+        _write_checkpoint(fp);
+        if (fclose(fp) == 0 && rename(tmp.c_str(), _ckpt_path.c_str()) == 0)
+          ret = 0;
+      }
+    }
+    pthread_mutex_unlock(&_ckpt_mutex);
+    return ret;
+  }
+
+  void print_checkpoint() {
+    pthread_mutex_lock(&_ckpt_mutex);
+    printf("%s\n", _ckpt_path.empty() ? "(none)" : _ckpt_path.c_str());
+    pthread_mutex_unlock(&_ckpt_mutex);
+  }
+
+  // loads a checkpoint written by checkpoint(); the next start carries
+  // on from it. Fails while a search is running.
+  int resume(const char *path) {
+    FILE *fp = fopen(path, "r");
+    int ret = -1;
+
+    if (fp == NULL)
+      return -1;
+    pthread_mutex_lock(&_ckpt_mutex);
+    lock();
+    if (_workers.empty())
+      ret = _read_checkpoint(fp);
+    unlock();
+    pthread_mutex_unlock(&_ckpt_mutex);
+    fclose(fp);
+    if (ret == 0)
+      clear_cache(); // the fitness parameters may have changed
+    return ret;
+  }
+
   // merkle damgard construction
-  // this function is DANGEROUS because it is not protected by the lock
-  uint64_t hash_value(const void *buf, size_t len) {
+  static uint64_t hash_value(const compiled &fin, const void *buf,
+                             size_t len) {
     const uint64_t m1 = 0xd36463187cc70d7bULL;
     const uint64_t m2 = 0xb597d0ceca3f6e07ULL;
     const uint64_t *pos = (const uint64_t *)buf;
@@ -481,7 +1181,70 @@ public:
 
     h = (ROR64(h, 33) + v) * m1;
 
-    return _process(h);
+    return fin(h);
+  }
+
+  // merkle damgard construction on 32-bit words, for g_width == 32
+  static uint32_t hash_value32(const compiled &fin, const void *buf,
+                               size_t len, uint32_t seed) {
+    const uint32_t m1 = 0x85ebca6bU;
+    const uint32_t m2 = 0xc2b2ae35U;
+    const unsigned char *pc = (const unsigned char *)buf;
+    uint32_t h = seed ^ ((uint32_t)len * m2);
+    uint32_t v;
+
+    for (; len >= 4; len -= 4, pc += 4) {
+      memcpy(&v, pc, 4);
+      h = (ROR32(h, 15) + v) * m1;
+    }
+
+    if (len) {
+      v = 0;
+      memcpy(&v, pc, len);
+      h = (ROR32(h, 15) + v) * m1;
+    }
+
+    return fin.run32(h);
+  }
+
+  // Merkle-Damgard construction around a searched block step with n
+  // lanes: word i of each block goes into lane i as
+  // lane = step(lane + word). Words left over after the last full block
+  // and the zero-padded tail fill the lanes in order. The lanes are then
+  // folded into lane 0 the same way, and absorbing the length closes the
+  // hash in place of a finalizer.
+  static uint64_t absorb_value(const compiled &step, int n, const void *buf,
+                               size_t len) {
+    const uint64_t m2 = 0xb597d0ceca3f6e07ULL;
+    const unsigned char *pc = (const unsigned char *)buf;
+    size_t block = 8 * n, left = len;
+    uint64_t lane[ABSORB_MAX];
+    uint64_t t;
+    int i;
+
+    // distinct starting values, so that lanes cannot trade words
+    for (i = 0; i < n; ++i)
+      lane[i] = (len + i) * m2;
+
+    if (left >= block) {
+      step.blocks(lane, n, pc, left / block);
+      pc += left / block * block;
+      left %= block;
+    }
+
+    for (i = 0; left >= 8; ++i, left -= 8, pc += 8) {
+      memcpy(&t, pc, 8);
+      lane[i] = step(lane[i] + t);
+    }
+    if (left) {
+      t = 0;
+      memcpy(&t, pc, left);
+      lane[i] = step(lane[i] + t);
+    }
+
+    for (i = 1; i < n; ++i)
+      lane[0] = step(lane[0] + lane[i]);
+    return step(lane[0] + len);
   }
 
   /*
@@ -531,32 +1294,40 @@ public:
   // global instance of this class, should be unique
   static hashgen *instance;
 
+  // hashes with the candidate being scored on this thread
   static uint64_t gen_hash(const void *buf, size_t len) {
-    return instance->hash_value(buf, len);
+    int lanes = g_absorb;
+
+    if (lanes)
+      return absorb_value(*_cur, lanes, buf, len);
+    // two seeds fill the 64 bits the avalanche test looks at
+    if (g_width == 32)
+      return hash_value32(*_cur, buf, len, 0) |
+             (uint64_t)hash_value32(*_cur, buf, len, 1) << 32;
+    return hash_value(*_cur, buf, len);
   }
 
 private:
-  uint64_t _process(uint64_t init) {
-    for (vector<op *>::const_iterator it = _op_seq.begin(); it != _op_seq.end();
-         ++it) {
-      switch ((*it)->type) {
+  static uint64_t _process(const op_seq &seq, uint64_t init) {
+    for (op_seq::const_iterator it = seq.begin(); it != seq.end(); ++it) {
+      switch (it->first) {
       case OP_MUL:
-        init *= (*it)->arg;
+        init *= it->second;
         break;
       case OP_ADD:
-        init += (*it)->arg;
+        init += it->second;
         break;
       case OP_XOR:
-        init ^= (*it)->arg;
+        init ^= it->second;
         break;
       case OP_XSL:
-        init ^= init << (*it)->arg;
+        init ^= init << it->second;
         break;
       case OP_XSR:
-        init ^= init >> (*it)->arg;
+        init ^= init >> it->second;
         break;
       case OP_ROR:
-        init ^= ROR64(init, (*it)->arg);
+        init ^= ROR64(init, it->second);
         break;
       case OP_NOT:
         init = ~init;
@@ -565,72 +1336,472 @@ private:
         init = __builtin_bswap64(init);
         break;
       case OP_ASL:
-        init += init << (*it)->arg;
+        init += init << it->second;
         break;
       case OP_SSL:
-        init -= init << (*it)->arg;
+        init -= init << it->second;
         break;
       case OP_SUB:
-        init -= (*it)->arg;
+        init -= it->second;
         break;
       case OP_LOR:
-        init <<= (*it)->arg;
+        init <<= it->second;
         break;
       case OP_XQO:
         // xorsquare from https://github.com/skeeto/hash-prospector/issues/23
         {
-          uint64_t n = (*it)->arg;
+          uint64_t n = it->second;
           init = (n|1ull)^(n*n);
         }
         break;
-      // init += ~(init << (*it)->arg)
-      // init -= ~(init << (*it)->arg)
+      // init += ~(init << it->second)
+      // init -= ~(init << it->second)
       case OP_NUM:
-        ULIB_FATAL("unknown op type:%d", (*it)->type);
+        ULIB_FATAL("unknown op type:%d", it->first);
       }
     }
     return init;
   }
 
-  bool _evolve() {
-    avalanche aval;
-    timespec timer;
-    float time_score;
-    bool ret = true;
+  // the block loop of absorb_value() on the interpreter
+  static void _absorb_blocks(const op_seq &seq, uint64_t *lane, int lanes,
+                             const void *buf, size_t n) {
+    const unsigned char *pc = (const unsigned char *)buf;
+    uint64_t t;
 
-    if (unlikely(_best_seen_score < 0)) {
-      // first time
-      _init_with_latest();
-      // warmup
-      for (int i = 0; i < 10; i++) {
-        (void)aval(gen_hash, g_aval_len, g_aval_times);
+    for (; n; --n)
+      for (int i = 0; i < lanes; ++i, pc += 8) {
+        memcpy(&t, pc, 8);
+        lane[i] = _process(seq, lane[i] + t);
+      }
+  }
+
+  // _process() with 32-bit words and multiplies
+  static uint32_t _process32(const op_seq &seq, uint32_t init) {
+    for (op_seq::const_iterator it = seq.begin(); it != seq.end(); ++it) {
+      uint32_t arg = (uint32_t)it->second;
+      switch (it->first) {
+      case OP_MUL:
+        init *= arg;
+        break;
+      case OP_ADD:
+        init += arg;
+        break;
+      case OP_XOR:
+        init ^= arg;
+        break;
+      case OP_XSL:
+        init ^= init << arg;
+        break;
+      case OP_XSR:
+        init ^= init >> arg;
+        break;
+      case OP_ROR:
+        init ^= ROR32(init, arg);
+        break;
+      case OP_NOT:
+        init = ~init;
+        break;
+      case OP_SWP:
+        init = __builtin_bswap32(init);
+        break;
+      case OP_ASL:
+        init += init << arg;
+        break;
+      case OP_SSL:
+        init -= init << arg;
+        break;
+      case OP_SUB:
+        init -= arg;
+        break;
+      case OP_LOR:
+        init <<= arg;
+        break;
+      case OP_XQO:
+        init = (arg | 1u) ^ (arg * arg);
+        break;
+      case OP_NUM:
+        ULIB_FATAL("unknown op type:%d", it->first);
       }
-      timer_start(&timer);
-      _best_seen_score = aval(gen_hash, g_aval_len, g_aval_times);
-      time_score = timer_stop(&timer) * g_time_r;
-      _best_seen_score += time_score;
-      printf("Best seen score: aval_score=%f, time_score=%f, overall=%f\n",
-             _best_seen_score - time_score, time_score, _best_seen_score);
-    } else {
-      timer_start(&timer);
-      float new_score = aval(gen_hash, g_aval_len, g_aval_times);
-      time_score = timer_stop(&timer) * g_time_r;
-      new_score += time_score;
-      if (new_score < _best_seen_score) {
-        // new score is better
-        _update_best_seen();
-        _best_seen_score = new_score;
-        printf("Updated best seen score: aval_score=%f, time_score=%f, "
-               "overall=%f\n",
-               _best_seen_score - time_score, time_score, _best_seen_score);
-      } else
-        ret = false;
     }
+    return init;
+  }
 
-    return ret;
+  // forgets the best seen result, the Pareto archive and any resumed
+  // thread states, for a change of the hash shape; called with the lock
+  // held and no search running
+  void _reset_search() {
+    _best_seen.clear();
+    _best_seen_score = -1;
+    _pareto.clear();
+    _resume.clear();
+  }
+
+  // scores the starting point, called with the lock held
+  void _init_best_seen() {
+    avalanche aval(rdtsc());
+    compiled fin;
+    fitness f;
+
+    _init_with_latest();
+    // warmup
+    for (int i = 0; i < 10; i++)
+      (void)score(_best_seen, aval, fin, HUGE_VALF);
+    f = score(_best_seen, aval, fin, HUGE_VALF);
+    _best_seen_score = f.overall();
+    printf("Best seen score: aval_score=%f, time_score=%f, overall=%f\n",
+           f.aval, f.time, _best_seen_score);
+  }
+
+  // median cycles per hash of TIME_REPEATS runs after a warm-up run
+  static float _time_mode(avalanche::hash_func_t h, bool latency) {
+    uint64_t in[TIME_INPUTS][TIME_LONG / 8];
+    size_t len = time_len();
+    // about as many words per run for long inputs
+    int n = g_absorb ? TIME_RUNS / 16 : TIME_RUNS;
+    float runs[TIME_REPEATS];
+    uint64_t volatile sink;
+
+    memcpy(in, g_time_inputs.buf, sizeof(in));
+    for (int r = -1; r < TIME_REPEATS; ++r) {
+      uint64_t t = rdtsc();
+      uint64_t acc = 0;
+      if (latency)
+        for (int i = 0; i < n; ++i)
+          in[0][0] ^= h(in[0], len);
+      else
+        for (int i = 0; i < n; ++i)
+          acc += h(in[i % TIME_INPUTS], len);
+      t = rdtsc() - t;
+      sink = acc;
+      if (r >= 0)
+        runs[r] = (float)t / n;
+    }
+    (void)sink;
+    sort(runs, runs + TIME_REPEATS);
+    return runs[TIME_REPEATS / 2];
+  }
+
+  static bool _by_cycles(const scored &a, const scored &b) {
+    return a.second.cycles < b.second.cycles;
+  }
+
+  // the smallest avalanche score of an archived candidate taking at
+  // most cycles, which a candidate must beat to enter the archive on
+  // avalanche score; HUGE_VALF if there is none. The bound only falls as
+  // the archive grows, so cached early results stay valid. Called with
+  // the lock held.
+  float _pareto_bound(float cycles) const {
+    float bound = HUGE_VALF;
+
+    for (size_t i = 0; i < _pareto.size(); ++i)
+      if (_pareto[i].second.cycles <= cycles)
+        bound = min(bound, _pareto[i].second.aval);
+    return bound;
+  }
+
+  // keeps seq if no archived candidate dominates it, dropping those it
+  // dominates; called with the lock held
+  void _pareto_add(const op_seq &seq, const fitness &f) {
+    size_t n = 0;
+
+    for (size_t i = 0; i < _pareto.size(); ++i) {
+      if (_pareto[i].second.dominates(f) || _pareto[i].first == seq)
+        return;
+      if (!f.dominates(_pareto[i].second))
+        _pareto[n++] = _pareto[i];
+    }
+    _pareto.resize(n);
+    if (n < PARETO_MAX)
+      _pareto.push_back(scored(seq, f));
+  }
+
+  static void *_on_timer(void *arg) {
+    if (((hashgen *)arg)->checkpoint())
+      ULIB_WARNING("cannot write checkpoint");
+    return NULL;
+  }
+
+  static void _write_seq(FILE *fp, const op_seq &seq) {
+    fprintf(fp, " %d", (int)seq.size());
+    for (op_seq::const_iterator it = seq.begin(); it != seq.end(); ++it)
+      fprintf(fp, " %d %llx", it->first, (unsigned long long)it->second);
+  }
+
+  static int _read_seq(FILE *fp, op_seq &seq) {
+    int n, t;
+    unsigned long long arg;
+
+    if (fscanf(fp, "%d", &n) != 1 || n < 0 || n > CKPT_MAX_SEQ)
+      return -1;
+    seq.clear();
+    while (n--) {
+      if (fscanf(fp, "%d %llx", &t, &arg) != 2 || t < 0 || t >= OP_NUM)
+        return -1;
+      seq.push_back(op((op_type)t, arg));
+    }
+    return 0;
+  }
+
+  static void _write_scored(FILE *fp, const scored &s) {
+    fprintf(fp, "%.9g %.9g %d %.9g %.9g %.9g", s.second.aval, s.second.time,
+            (int)s.second.early, s.second.bias, s.second.cycles,
+            s.second.tput);
+    _write_seq(fp, s.first);
+    fprintf(fp, "\n");
+  }
+
+  static int _read_scored(FILE *fp, scored &s) {
+    int early;
+
+    if (fscanf(fp, "%g %g %d %g %g %g", &s.second.aval, &s.second.time,
+               &early, &s.second.bias, &s.second.cycles, &s.second.tput) != 6)
+      return -1;
+    s.second.early = early;
+    return _read_seq(fp, s.first);
+  }
+
+  // called with _ckpt_mutex held, which keeps _workers as it is; the
+  // lock is only taken for the shared state, search threads may need it
+  // to finish the step that save() waits for
+  void _write_checkpoint(FILE *fp) {
+    vector<searcher_state> states = _resume;
+
+    fprintf(fp, "hashgen-checkpoint 2\n");
+    fprintf(fp, "param width %d\n", g_width);
+    fprintf(fp, "param absorb %d\n", g_absorb);
+    fprintf(fp, "param aval_byte %d\n", g_aval_len);
+    fprintf(fp, "param aval_times %d\n", g_aval_times);
+    fprintf(fp, "param aval_rate %.9g\n", g_aval_r);
+    fprintf(fp, "param indep_rate %.9g\n", g_indep_r);
+    fprintf(fp, "param time_rate %.9g\n", g_time_r);
+    fprintf(fp, "param aval_conf %.9g\n", g_aval_k);
+    fprintf(fp, "param min_seq %d\n", _min_seq);
+    fprintf(fp, "param max_seq %d\n", _max_seq);
+    fprintf(fp, "param workers %d\n", _nworkers);
+    fprintf(fp, "param population %d\n", _pop_size);
+    fprintf(fp, "param migrate %d\n", _migrate);
+    fprintf(fp, "param temp %.9g\n", _temp);
+    fprintf(fp, "param cooling %.9g\n", _cooling);
+    fprintf(fp, "param swap %d\n", _swap);
+
+    lock();
+    fprintf(fp, "strategy %s\n", _strategy->name());
+    fprintf(fp, "counters %llu %llu %llu\n", (unsigned long long)_evals,
+            (unsigned long long)_aborts, (unsigned long long)_updates);
+    if (_best_seen_score >= 0) {
+      fprintf(fp, "best %.9g", _best_seen_score);
+      _write_seq(fp, _best_seen);
+      fprintf(fp, "\n");
+    }
+    for (size_t i = 0; i < _pareto.size(); ++i) {
+      fprintf(fp, "pareto ");
+      _write_scored(fp, _pareto[i]);
+    }
+    unlock();
+
+    if (!_workers.empty()) {
+      states.resize(_workers.size());
+      for (size_t i = 0; i < _workers.size(); ++i)
+        _workers[i]->save(states[i]);
+    }
+    for (size_t i = 0; i < states.size(); ++i) {
+      const searcher_state &st = states[i];
+      fprintf(fp, "searcher");
+      for (int k = 0; k < 6; ++k)
+        fprintf(fp, " %llx", (unsigned long long)st.rng[k]);
+      fprintf(fp, " %.17g %d\n", st.extra, (int)st.seqs.size());
+      for (size_t k = 0; k < st.seqs.size(); ++k)
+        _write_scored(fp, st.seqs[k]);
+    }
+    fprintf(fp, "end\n"); // tells a complete file from a truncated one
+  }
+
+  // shift and rotate counts must stay below the word size
+  static int _check_seq(const op_seq &seq, int width) {
+    for (op_seq::const_iterator it = seq.begin(); it != seq.end(); ++it)
+      switch (it->first) {
+      case OP_XSL:
+      case OP_XSR:
+      case OP_ROR:
+      case OP_ASL:
+      case OP_SSL:
+      case OP_LOR:
+        if (it->second < 1 || it->second >= (uint64_t)width)
+          return -1;
+        break;
+      default:
+        break;
+      }
+    return 0;
+  }
+
+  // applies a parameter that passed check_param() and
+  // _check_checkpoint(), which checks min_seq and max_seq together
+  void _load_param(const char *name, const char *value) {
+    if (!strcmp(name, "width"))
+      g_width = atoi(value);
+    else if (!strcmp(name, "absorb"))
+      g_absorb = atoi(value);
+    else if (!strcmp(name, "aval_byte"))
+      g_aval_len = atoi(value);
+    else if (!strcmp(name, "aval_times"))
+      g_aval_times = atoi(value);
+    else if (!strcmp(name, "aval_rate"))
+      g_aval_r = atof(value);
+    else if (!strcmp(name, "indep_rate"))
+      g_indep_r = atof(value);
+    else if (!strcmp(name, "time_rate"))
+      g_time_r = atof(value);
+    else if (!strcmp(name, "aval_conf"))
+      g_aval_k = atof(value);
+    else if (!strcmp(name, "min_seq"))
+      _min_seq = atoi(value);
+    else if (!strcmp(name, "max_seq"))
+      _max_seq = atoi(value);
+    else if (!strcmp(name, "workers"))
+      set_workers(atoi(value));
+    else if (!strcmp(name, "population"))
+      set_pop_size(atoi(value));
+    else if (!strcmp(name, "migrate"))
+      set_migrate(atoi(value));
+    else if (!strcmp(name, "temp"))
+      set_temp(atof(value));
+    else if (!strcmp(name, "cooling"))
+      set_cooling(atof(value));
+    else if (!strcmp(name, "swap"))
+      set_swap(atoi(value));
+  }
+
+  struct checkpoint_data;
+
+  // Called with both locks held and no search running. The whole file
+  // is parsed and checked before any of it replaces the live state, so
+  // a truncated or corrupt checkpoint changes nothing.
+  int _read_checkpoint(FILE *fp) {
+    checkpoint_data ck;
+    int ret = _parse_checkpoint(fp, ck);
+
+    if (ret == 0)
+      ret = _check_checkpoint(ck);
+    if (ret) {
+      delete ck.strat;
+      return -1;
+    }
+    for (size_t i = 0; i < ck.params.size(); ++i)
+      _load_param(ck.params[i].first.c_str(), ck.params[i].second.c_str());
+    if (ck.strat) {
+      delete _strategy;
+      _strategy = ck.strat;
+    }
+    _evals = ck.evals;
+    _aborts = ck.aborts;
+    _updates = ck.updates;
+    _best_seen = ck.best;
+    _best_seen_score = ck.best_score;
+    _pareto = ck.pareto;
+    _resume = ck.states;
+    return 0;
+  }
+
+  int _parse_checkpoint(FILE *fp, checkpoint_data &ck) {
+    char tag[32], name[32], value[64];
+    int ver;
+
+    if (fscanf(fp, "hashgen-checkpoint %d", &ver) != 1 || ver != 2)
+      return -1;
+    while (fscanf(fp, "%31s", tag) == 1) {
+      if (!strcmp(tag, "end"))
+        return 0;
+      if (!strcmp(tag, "param")) {
+        if (fscanf(fp, "%31s %63s", name, value) != 2 ||
+            check_param(name, value))
+          return -1;
+        ck.params.push_back(pair<string, string>(name, value));
+      } else if (!strcmp(tag, "strategy")) {
+        if (ck.strat || fscanf(fp, "%31s", name) != 1 ||
+            !(ck.strat = new_strategy(name)))
+          return -1;
+      } else if (!strcmp(tag, "counters")) {
+        unsigned long long evals, aborts, updates;
+        if (fscanf(fp, "%llu %llu %llu", &evals, &aborts, &updates) != 3)
+          return -1;
+        ck.evals = evals;
+        ck.aborts = aborts;
+        ck.updates = updates;
+      } else if (!strcmp(tag, "best")) {
+        if (fscanf(fp, "%g", &ck.best_score) != 1 ||
+            !(ck.best_score >= 0) || _read_seq(fp, ck.best))
+          return -1;
+      } else if (!strcmp(tag, "pareto")) {
+        scored p;
+        if (ck.pareto.size() >= PARETO_MAX || _read_scored(fp, p))
+          return -1;
+        ck.pareto.push_back(p);
+      } else if (!strcmp(tag, "searcher")) {
+        searcher_state st;
+        unsigned long long rng[6];
+        int n;
+        if (ck.states.size() >= CKPT_MAX_THREADS ||
+            fscanf(fp, "%llx %llx %llx %llx %llx %llx %lg %d", rng, rng + 1,
+                   rng + 2, rng + 3, rng + 4, rng + 5, &st.extra, &n) != 8 ||
+            n < 0 || n > CKPT_MAX_SEQS)
+          return -1;
+        for (int k = 0; k < 6; ++k)
+          st.rng[k] = rng[k];
+        st.seqs.resize(n);
+        for (int k = 0; k < n; ++k)
+          if (_read_scored(fp, st.seqs[k]))
+            return -1;
+        ck.states.push_back(st);
+      } else
+        return -1;
+    }
+    return -1; // no end line
   }
 
-  char *_print_op(pair<op_type, uint64_t> it, char *buf) {
+  // checks the sequences against the word size the checkpoint sets
+  int _check_checkpoint(const checkpoint_data &ck) const {
+    int width = g_width, absorb = g_absorb;
+    int min_seq = _min_seq, max_seq = _max_seq;
+
+    for (size_t i = 0; i < ck.params.size(); ++i) {
+      const char *value = ck.params[i].second.c_str();
+      if (ck.params[i].first == "width")
+        width = atoi(value);
+      else if (ck.params[i].first == "absorb")
+        absorb = atoi(value);
+      else if (ck.params[i].first == "min_seq")
+        min_seq = atoi(value);
+      else if (ck.params[i].first == "max_seq")
+        max_seq = atoi(value);
+    }
+    if ((absorb && width != 64) || min_seq > max_seq)
+      return -1;
+    if (_check_seq(ck.best, width))
+      return -1;
+    for (size_t i = 0; i < ck.pareto.size(); ++i)
+      if (_check_seq(ck.pareto[i].first, width))
+        return -1;
+    for (size_t i = 0; i < ck.states.size(); ++i)
+      for (size_t k = 0; k < ck.states[i].seqs.size(); ++k)
+        if (_check_seq(ck.states[i].seqs[k].first, width))
+          return -1;
+    return 0;
+  }
+
+  void _print_cache() {
+    uint64_t total = _hits + _misses;
+
+    printf("cache: %llu entries, %llu hits, %llu misses",
+           (unsigned long long)_cache.size(), (unsigned long long)_hits,
+           (unsigned long long)_misses);
+    if (total)
+      printf(", hit rate %.1f%%", 100.0 * _hits / total);
+    printf("\n");
+  }
+
+  static char *_print_op(op it, char *buf) {
     switch (it.first) {
     case OP_MUL:
       snprintf(buf, BUF_SIZE, "MUL(%016llx)", (unsigned long long)it.second);
@@ -679,8 +1850,7 @@ private:
 
   void _print_best_seen() {
     printf("Best seen combination: ");
-    for (vector<pair<op_type, uint64_t>>::const_iterator it =
-             _best_seen.begin();
+    for (op_seq::const_iterator it = _best_seen.begin();
          it != _best_seen.end(); ++it) {
       char buf[BUF_SIZE];
       printf("%s ", _print_op(*it, buf));
@@ -691,10 +1861,15 @@ private:
   // start with a good baseline, what Zilong Tan computed as best in 2012.
   // and then get at least 2x as good.
   void _init_with_latest() {
-    _best_seen.clear();
-    _op_seq.clear();
-
-    pair<op_type, uint64_t> ts[] = {
+    // murmur3 fmix32
+    op ts32[] = {
+        {OP_XSR, 16},
+        {OP_MUL, 0x85ebca6bULL},
+        {OP_XSR, 13},
+        {OP_MUL, 0xc2b2ae35ULL},
+        {OP_XSR, 16},
+    };
+    op ts[] = {
 #ifdef START_WITH_FASTHASH
         {OP_XSR, 23},
         {OP_MUL, 0x2127599bf4325c37ULL},
@@ -713,119 +1888,495 @@ private:
         {OP_XSR, 34},
 #endif
     };
-    for (unsigned i = 0; i < ARR_SIZE(ts); i++) {
-      auto t = ts[i];
-      op *new_op = new op(t.first, hashgen::instance);
-      new_op->arg = t.second;
-      _op_seq.push_back(new_op);
-      _best_seen.push_back(t);
-    }
+    // block step: a multiply, and a shift to feed the high bits back
+    op absorb[] = {
+        {OP_MUL, 0x2127599bf4325c37ULL},
+        {OP_XSR, 29},
+    };
+    if (g_absorb)
+      _best_seen.assign(absorb, absorb + ARR_SIZE(absorb));
+    else if (g_width == 32)
+      _best_seen.assign(ts32, ts32 + ARR_SIZE(ts32));
+    else
+      _best_seen.assign(ts, ts + ARR_SIZE(ts));
 
     _print_best_seen();
   }
 
-  void _update_best_seen() {
-    _best_seen.clear();
-    for (vector<op *>::const_iterator it = _op_seq.begin(); it != _op_seq.end();
-         ++it) {
-      pair<op_type, uint64_t> t;
-      t.first = (*it)->type;
-      t.second = (*it)->arg;
-      _best_seen.push_back(t);
-    }
-    _print_best_seen();
-  }
+  // what a checkpoint holds of one search thread
+  struct searcher_state {
+    uint64_t rng[6]; // mutation, then avalanche RNG
+    double extra;
+    vector<scored> seqs;
+  };
 
-  class thread_add_op : public thread {
+  // A search thread. Subclasses keep all their state in the RNGs, _seqs
+  // and _extra, and advance it one candidate per step(). Steps run
+  // under _state_mutex so that save() sees the state between two
+  // candidates.
+  class searcher : public thread {
   public:
-    thread_add_op(hashgen *gen) : _gen(gen) {
-      uint64_t now = rdtsc();
-      RAND_NR_INIT(_u, _v, _w, now);
+    searcher(hashgen *gen, uint64_t seed) : _gen(gen), _aval(seed), _extra(0) {
+      RAND_NR_INIT(_u, _v, _w, seed);
+      pthread_mutex_init(&_state_mutex, NULL);
     }
 
-    ~thread_add_op() { stop_and_join(); }
+    // subclasses call stop_and_join() in their own destructor, step()
+    // must not outlive them
+    ~searcher() { pthread_mutex_destroy(&_state_mutex); }
 
     int run() {
-      while (is_running())
-        _gen->add_op(RAND_NR_NEXT(_u, _v, _w));
+      while (is_running()) {
+        pthread_mutex_lock(&_state_mutex);
+        step();
+        pthread_mutex_unlock(&_state_mutex);
+      }
       return 0;
     }
 
-  private:
+    virtual void step() = 0;
+
+    void save(searcher_state &s) {
+      pthread_mutex_lock(&_state_mutex);
+      s.rng[0] = _u;
+      s.rng[1] = _v;
+      s.rng[2] = _w;
+      _aval.get_state(s.rng + 3);
+      s.extra = _extra;
+      s.seqs = _seqs;
+      pthread_mutex_unlock(&_state_mutex);
+    }
+
+    // before start() only
+    void restore(const searcher_state &s) {
+      _u = s.rng[0];
+      _v = s.rng[1];
+      _w = s.rng[2];
+      _aval.set_state(s.rng + 3);
+      _extra = s.extra;
+      _seqs = s.seqs;
+    }
+
+  protected:
     hashgen *_gen;
+    avalanche _aval;
+    compiled _fin;
     uint64_t _u, _v, _w;
-  } * ctrl_add_op;
+    vector<scored> _seqs; // sequences the search carries along
+    double _extra;        // one more number it carries along
 
-  class thread_del_op : public thread {
+  private:
+    pthread_mutex_t _state_mutex;
+  };
+
+  // mutates and scores private copies of the best seen sequence; only
+  // publish() takes the lock
+  class worker : public searcher {
   public:
-    thread_del_op(hashgen *gen) : _gen(gen) {
-      uint64_t now = rdtsc();
-      RAND_NR_INIT(_u, _v, _w, now);
+    worker(hashgen *gen, uint64_t seed) : searcher(gen, seed) {}
+
+    ~worker() { stop_and_join(); }
+
+    void step() {
+      op_seq seq = _gen->best_seen();
+      if (!_gen->mutate(seq, _u, _v, _w))
+        return;
+      _gen->publish(seq,
+                    _gen->evaluate(seq, _aval, _fin, _gen->best_target()));
     }
+  };
 
-    ~thread_del_op() { stop_and_join(); }
+  // A search strategy creates the threads of a run. The threads explore
+  // on their own and report through evaluate() and publish(); whatever
+  // they share lives in the strategy.
+  class strategy {
+  public:
+    virtual ~strategy() {}
 
-    int run() {
-      while (is_running())
-        _gen->del_op(RAND_NR_NEXT(_u, _v, _w));
-      return 0;
+    virtual const char *name() const = 0;
+
+    // called before the n threads of a run are spawned
+    virtual void prepare(hashgen *, int) {}
+
+    virtual searcher *spawn(hashgen *gen, uint64_t seed, int id) = 0;
+
+    // called once the threads of a run are gone
+    virtual void release() {}
+
+    // called with the lock held
+    virtual void print_stats() {}
+  };
+
+  class greedy : public strategy {
+  public:
+    const char *name() const { return "greedy"; }
+
+    searcher *spawn(hashgen *gen, uint64_t seed, int) {
+      return new worker(gen, seed);
+    }
+  };
+
+  // migrants on their way to an island
+  struct inbox {
+    pthread_mutex_t mutex;
+    vector<scored> seqs;
+
+    inbox() { pthread_mutex_init(&mutex, NULL); }
+
+    ~inbox() { pthread_mutex_destroy(&mutex); }
+
+    void put(const scored &s) {
+      pthread_mutex_lock(&mutex);
+      seqs.push_back(s);
+      pthread_mutex_unlock(&mutex);
+    }
+
+    void take(vector<scored> &out) {
+      pthread_mutex_lock(&mutex);
+      out = seqs;
+      seqs.clear();
+      pthread_mutex_unlock(&mutex);
+    }
+  };
+
+  // a steady-state population evolved by tournament selection,
+  // crossover and mutation. Children replace the worst member if they
+  // beat it; every _migrate children the best member is sent to the
+  // next island. Islands only share the fitness cache and publish().
+  // _extra counts the children.
+  class island : public searcher {
+  public:
+    island(hashgen *gen, vector<inbox *> &inboxes, uint64_t seed, int id)
+        : searcher(gen, seed), _inboxes(inboxes), _id(id) {}
+
+    ~island() { stop_and_join(); }
+
+    void step() {
+      if ((int)_seqs.size() < _gen->_pop_size) {
+        _populate();
+        return;
+      }
+      _immigrate();
+
+      op_seq child;
+      const op_seq &a = _seqs[_tournament()].first;
+      const op_seq &b = _seqs[_tournament()].first;
+
+      // crossover most of the time, mutation of a copy otherwise, and
+      // sometimes both
+      uint64_t r = RAND_NR_NEXT(_u, _v, _w) % 10;
+      if (r < 7 && _gen->crossover(a, b, child, _u, _v, _w)) {
+        if (r < 2)
+          _gen->mutate(child, _u, _v, _w);
+      } else {
+        child = a;
+        if (!_gen->mutate(child, _u, _v, _w))
+          return;
+      }
+      if (_find(child) >= 0)
+        return;
+
+      size_t worst = _worst();
+      fitness f = _gen->evaluate(child, _aval, _fin,
+                                 _seqs[worst].second.overall());
+      if (!f.early) {
+        _gen->publish(child, f);
+        if (f.overall() < _seqs[worst].second.overall())
+          _seqs[worst] = scored(child, f);
+      }
+      _extra += 1;
+      if ((uint64_t)_extra % _gen->_migrate == 0) {
+        size_t next = (_id + 1) % _inboxes.size();
+        _inboxes[next]->put(_seqs[_best()]);
+      }
     }
 
   private:
-    hashgen *_gen;
-    uint64_t _u, _v, _w;
-  } * ctrl_del_op;
+    // adds the best seen result, or a mutant of it
+    void _populate() {
+      op_seq seq = _gen->best_seen();
+
+      if (!_seqs.empty())
+        for (int i = RAND_NR_NEXT(_u, _v, _w) % 3; i >= 0; --i)
+          _gen->mutate(seq, _u, _v, _w);
+      if (_find(seq) >= 0)
+        return;
+      _seqs.push_back(
+          scored(seq, _gen->evaluate(seq, _aval, _fin, HUGE_VALF)));
+    }
 
-  class thread_mod_op : public thread {
+    void _immigrate() {
+      vector<scored> in;
+
+      _inboxes[_id]->take(in);
+      for (vector<scored>::iterator it = in.begin(); it != in.end(); ++it) {
+        size_t worst = _worst();
+        if (_find(it->first) < 0 &&
+            it->second.overall() < _seqs[worst].second.overall())
+          _seqs[worst] = *it;
+      }
+    }
+
+    // index of the best of 3 random members
+    size_t _tournament() {
+      size_t best = RAND_NR_NEXT(_u, _v, _w) % _seqs.size();
+      for (int i = 1; i < 3; ++i) {
+        size_t k = RAND_NR_NEXT(_u, _v, _w) % _seqs.size();
+        if (_seqs[k].second.overall() < _seqs[best].second.overall())
+          best = k;
+      }
+      return best;
+    }
+
+    size_t _best() const {
+      size_t best = 0;
+      for (size_t i = 1; i < _seqs.size(); ++i)
+        if (_seqs[i].second.overall() < _seqs[best].second.overall())
+          best = i;
+      return best;
+    }
+
+    size_t _worst() const {
+      size_t worst = 0;
+      for (size_t i = 1; i < _seqs.size(); ++i)
+        if (_seqs[i].second.overall() > _seqs[worst].second.overall())
+          worst = i;
+      return worst;
+    }
+
+    int _find(const op_seq &seq) const {
+      for (size_t i = 0; i < _seqs.size(); ++i)
+        if (_seqs[i].first == seq)
+          return i;
+      return -1;
+    }
+
+    vector<inbox *> &_inboxes;
+    size_t _id;
+  };
+
+  class ga : public strategy {
   public:
-    thread_mod_op(hashgen *gen) : _gen(gen) {
-      uint64_t now = rdtsc();
-      RAND_NR_INIT(_u, _v, _w, now);
+    ~ga() { release(); }
+
+    const char *name() const { return "ga"; }
+
+    void prepare(hashgen *, int n) {
+      for (int i = 0; i < n; ++i)
+        _inboxes.push_back(new inbox);
     }
 
-    ~thread_mod_op() { stop_and_join(); }
+    searcher *spawn(hashgen *gen, uint64_t seed, int id) {
+      return new island(gen, _inboxes, seed, id);
+    }
 
-    int run() {
-      while (is_running())
-        _gen->mod_op(RAND_NR_NEXT(_u, _v, _w));
-      return 0;
+    // no island is left to migrate into these
+    void release() {
+      for (vector<inbox *>::iterator it = _inboxes.begin();
+           it != _inboxes.end(); ++it)
+        delete *it;
+      _inboxes.clear();
     }
 
   private:
-    hashgen *_gen;
-    uint64_t _u, _v, _w;
-  } * ctrl_mod_op;
+    vector<inbox *> _inboxes; // one per island
+  };
 
-  class thread_swap_op : public thread {
+  // independent annealing chains: each starts from the best seen result
+  // at temperature _temp, cools by _cooling per candidate and starts
+  // over once a thousand times colder. _seqs holds the current state,
+  // _extra the temperature.
+  class annealer : public searcher {
   public:
-    thread_swap_op(hashgen *gen) : _gen(gen) {
-      uint64_t now = rdtsc();
-      RAND_NR_INIT(_u, _v, _w, now);
+    annealer(hashgen *gen, uint64_t seed) : searcher(gen, seed) {}
+
+    ~annealer() { stop_and_join(); }
+
+    void step() {
+      if (_seqs.empty() || _extra <= _gen->_temp * 1e-3f) {
+        op_seq seq = _gen->best_seen();
+        _seqs.assign(
+            1, scored(seq, _gen->evaluate(seq, _aval, _fin, HUGE_VALF)));
+        _extra = _gen->_temp;
+        return;
+      }
+      _gen->anneal_step(_seqs[0], _extra, _aval, _fin, _u, _v, _w);
+      _extra *= _gen->_cooling;
     }
+  };
 
-    ~thread_swap_op() { stop_and_join(); }
+  class sa : public strategy {
+  public:
+    const char *name() const { return "sa"; }
 
-    int run() {
-      while (is_running())
-        _gen->swap_op(RAND_NR_NEXT(_u, _v, _w));
-      return 0;
+    searcher *spawn(hashgen *gen, uint64_t seed, int) {
+      return new annealer(gen, seed);
+    }
+  };
+
+  // Parallel tempering: replica i runs Metropolis steps at temperature
+  // i of a geometric ladder from _temp / 20 up to _temp. Every _swap
+  // steps a replica offers to trade states with the next hotter one.
+  // Replicas publish their state to the ladder after each step; one
+  // whose state was traded away drops its step and takes the new one.
+  class tempering : public strategy {
+  public:
+    tempering() : _tries(0), _swaps(0) { pthread_mutex_init(&_mutex, NULL); }
+
+    ~tempering() { pthread_mutex_destroy(&_mutex); }
+
+    const char *name() const { return "pt"; }
+
+    void prepare(hashgen *gen, int n) {
+      float tmax = gen->_temp;
+      float tmin = tmax / 20;
+
+      _states.assign(n, scored());
+      _ready.assign(n, 0);
+      _moved.assign(n, 0);
+      _temps.resize(n);
+      for (int i = 0; i < n; ++i)
+        _temps[i] = tmin * powf(tmax / tmin, n > 1 ? (float)i / (n - 1) : 0);
+      _tries = _swaps = 0;
+    }
+
+    searcher *spawn(hashgen *gen, uint64_t seed, int id) {
+      return new replica(gen, this, seed, id);
+    }
+
+    void print_stats() {
+      printf("replica swaps: %llu of %llu accepted\n",
+             (unsigned long long)_swaps, (unsigned long long)_tries);
     }
 
+    // stores the state of replica i, or loads it if a swap replaced it
+    void exchange(int i, scored &cur, bool try_swap, uint64_t &u,
+                  uint64_t &v, uint64_t &w) {
+      int j = i + 1;
+
+      pthread_mutex_lock(&_mutex);
+      if (_moved[i]) {
+        cur = _states[i];
+        _moved[i] = 0;
+      } else
+        _states[i] = cur;
+      _ready[i] = 1;
+      if (try_swap && j < (int)_states.size() && _ready[j]) {
+        float d = (1 / _temps[i] - 1 / _temps[j]) *
+                  (_states[i].second.overall() - _states[j].second.overall());
+        ++_tries;
+        if (d >= 0 || uniform(u, v, w) < expf(d)) {
+          scored t = _states[i];
+          _states[i] = _states[j];
+          _states[j] = t;
+          _moved[j] = 1;
+          cur = _states[i];
+          ++_swaps;
+        }
+      }
+      pthread_mutex_unlock(&_mutex);
+    }
+
+    float temp(int i) const { return _temps[i]; }
+
   private:
-    hashgen *_gen;
-    uint64_t _u, _v, _w;
-  } * ctrl_swap_op;
+    pthread_mutex_t _mutex;
+    vector<scored> _states;
+    vector<char> _ready; // _states holds a scored state
+    vector<char> _moved; // swapped in, the replica must pick it up
+    vector<float> _temps;
+    uint64_t _tries;
+    uint64_t _swaps;
+  };
+
+  // _seqs holds the current state of the replica, _extra counts steps
+  class replica : public searcher {
+  public:
+    replica(hashgen *gen, tempering *pt, uint64_t seed, int id)
+        : searcher(gen, seed), _pt(pt), _id(id) {}
+
+    ~replica() { stop_and_join(); }
+
+    void step() {
+      if (_seqs.empty()) {
+        op_seq seq = _gen->best_seen();
+        _seqs.assign(
+            1, scored(seq, _gen->evaluate(seq, _aval, _fin, HUGE_VALF)));
+        return;
+      }
+      _pt->exchange(_id, _seqs[0], (uint64_t)_extra % _gen->_swap == 0, _u,
+                    _v, _w);
+      _gen->anneal_step(_seqs[0], _pt->temp(_id), _aval, _fin, _u, _v, _w);
+      _extra += 1;
+    }
+
+  private:
+    tempering *_pt;
+    int _id;
+  };
+
+  // NULL for unknown names
+  static strategy *new_strategy(const char *name) {
+    if (!strcmp(name, "greedy"))
+      return new greedy;
+    if (!strcmp(name, "ga"))
+      return new ga;
+    if (!strcmp(name, "sa"))
+      return new sa;
+    if (!strcmp(name, "pt"))
+      return new tempering;
+    return NULL;
+  }
+
+  // a checkpoint as read, before it is checked and applied
+  struct checkpoint_data {
+    vector<pair<string, string> > params;
+    strategy *strat; // NULL keeps the current one
+    uint64_t evals, aborts, updates;
+    float best_score; // negative without a best line
+    op_seq best;
+    vector<scored> pareto;
+    vector<searcher_state> states;
+
+    checkpoint_data()
+        : strat(NULL), evals(0), aborts(0), updates(0), best_score(-1) {}
+  };
 
   int volatile _min_seq;
   int volatile _max_seq;
+  int volatile _nworkers;
+  strategy *_strategy;
+  int volatile _pop_size; // members per island
+  int volatile _migrate;  // children between migrations
+  float volatile _temp;    // starting, or hottest, temperature
+  float volatile _cooling; // annealing factor per candidate
+  int volatile _swap;      // tempering steps between replica swaps
 
   pthread_mutex_t _mutex;
-  vector<op *> _op_seq;
+  vector<searcher *> _workers;
+  vector<searcher_state> _resume; // loaded thread states for start()
+
+  periodic _timer;
+  periodic::taskid_t _ckpt_task;
+  string _ckpt_path;
+  pthread_mutex_t _ckpt_mutex; // keeps _workers while checkpointing
+  timespec _started;
   float volatile _best_seen_score;
-  vector<pair<op_type, uint64_t>> _best_seen; // best seen result
+  op_seq _best_seen; // best seen result
+  uint64_t volatile _evals;
+  uint64_t volatile _aborts; // evaluations cut short by the bound
+  uint64_t _updates;
+  align_hash_map<seq_key, fitness> _cache; // fitness by sequence
+  uint64_t _hits;
+  uint64_t _misses;
+  unsigned _cache_gen; // bumped whenever the cache is cleared
+  vector<scored> _pareto; // non-dominated candidates
+
+  static thread_local const compiled *_cur;
 };
 
 hashgen *hashgen::instance = NULL;
+thread_local const hashgen::compiled *hashgen::_cur = NULL;
 
 int cmd_start(int, const char **) {
   if (hashgen::instance == NULL) {
@@ -836,48 +2387,123 @@ int cmd_start(int, const char **) {
   return 0;
 }
 
+// cached scores are only valid for the fitness parameters they were
+// computed with
+static void clear_cache() {
+  if (hashgen::instance)
+    hashgen::instance->clear_cache();
+}
+
 int cmd_aval_rate(int argc, const char *argv[]) {
-  if (argc > 1)
+  if (argc > 1) {
     g_aval_r = atof(argv[1]);
+    clear_cache();
+  }
   printf("%f\n", g_aval_r);
   return 0;
 }
 
 int cmd_indep_rate(int argc, const char *argv[]) {
-  if (argc > 1)
+  if (argc > 1) {
     g_indep_r = atof(argv[1]);
+    clear_cache();
+  }
   printf("%f\n", g_indep_r);
   return 0;
 }
 
 int cmd_time_rate(int argc, const char *argv[]) {
-  if (argc > 1)
+  if (argc > 1) {
     g_time_r = atof(argv[1]);
+    clear_cache();
+  }
   printf("%f\n", g_time_r);
   return 0;
 }
 
+int cmd_aval_conf(int argc, const char *argv[]) {
+  if (argc > 1) {
+    g_aval_k = atof(argv[1]);
+    clear_cache();
+  }
+  printf("%f\n", g_aval_k);
+  return 0;
+}
+
 int cmd_aval_byte(int argc, const char *argv[]) {
-  if (argc > 1)
+  if (argc > 1) {
+    if (hashgen::check_param("aval_byte", argv[1])) {
+      printf("aval_byte must be 1 to %d\n", AVAL_MAX);
+      return -1;
+    }
     g_aval_len = atoi(argv[1]);
+    clear_cache();
+  }
   printf("%d\n", g_aval_len);
   return 0;
 }
 
 int cmd_aval_times(int argc, const char *argv[]) {
-  if (argc > 1)
+  if (argc > 1) {
+    if (hashgen::check_param("aval_times", argv[1])) {
+      printf("aval_times must be 1 to %d\n", AVAL_TIMES_MAX);
+      return -1;
+    }
     g_aval_times = atoi(argv[1]);
+    clear_cache();
+  }
   printf("%d\n", g_aval_times);
   return 0;
 }
 
+int cmd_width(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1) {
+    int w = atoi(argv[1]);
+    if ((w != 32 && w != 64) || (w == 32 && g_absorb) ||
+        hashgen::instance->set_width(w)) {
+      printf("width must be 32 or 64, and 64 while absorb is set; set "
+             "before start\n");
+      return -1;
+    }
+  }
+  printf("%d\n", g_width);
+  return 0;
+}
+
+// the block step is only searched on 64-bit words
+int cmd_absorb(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1) {
+    int n = atoi(argv[1]);
+    if ((n != 0 && n != 1 && n != 2 && n != 4) || (n && g_width != 64) ||
+        hashgen::instance->set_absorb(n)) {
+      printf("absorb must be 0, 1, 2 or 4, and needs width 64; set before "
+             "start\n");
+      return -1;
+    }
+  }
+  printf("%d\n", g_absorb);
+  return 0;
+}
+
 int cmd_min_seq(int argc, const char *argv[]) {
   if (hashgen::instance == NULL) {
     ULIB_FATAL("instance is NULL");
     return -1;
   }
-  if (argc > 1)
-    hashgen::instance->set_min_seq(atoi(argv[1]));
+  if (argc > 1 && (hashgen::check_param("min_seq", argv[1]) ||
+                   hashgen::instance->set_min_seq(atoi(argv[1])))) {
+    printf("min_seq must be 1 to max_seq (%d)\n",
+           hashgen::instance->get_max_seq());
+    return -1;
+  }
   printf("%d\n", hashgen::instance->get_min_seq());
   return 0;
 }
@@ -887,12 +2513,170 @@ int cmd_max_seq(int argc, const char *argv[]) {
     ULIB_FATAL("instance is NULL");
     return -1;
   }
-  if (argc > 1)
-    hashgen::instance->set_max_seq(atoi(argv[1]));
+  if (argc > 1 && (hashgen::check_param("max_seq", argv[1]) ||
+                   hashgen::instance->set_max_seq(atoi(argv[1])))) {
+    printf("max_seq must be min_seq (%d) to %d\n",
+           hashgen::instance->get_min_seq(), CKPT_MAX_SEQ);
+    return -1;
+  }
   printf("%d\n", hashgen::instance->get_max_seq());
   return 0;
 }
 
+int cmd_workers(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1) {
+    if (hashgen::check_param("workers", argv[1])) {
+      printf("workers must be 1 to %d\n", CKPT_MAX_THREADS);
+      return -1;
+    }
+    hashgen::instance->set_workers(atoi(argv[1]));
+  }
+  printf("%d\n", hashgen::instance->get_workers());
+  return 0;
+}
+
+int cmd_strategy(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1 && hashgen::instance->set_strategy(argv[1])) {
+    printf("strategy must be greedy, ga, sa or pt, set before start\n");
+    return -1;
+  }
+  printf("%s\n", hashgen::instance->get_strategy());
+  return 0;
+}
+
+int cmd_population(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1) {
+    if (hashgen::check_param("population", argv[1])) {
+      printf("population must be 4 to %d\n", CKPT_MAX_SEQS);
+      return -1;
+    }
+    hashgen::instance->set_pop_size(atoi(argv[1]));
+  }
+  printf("%d\n", hashgen::instance->get_pop_size());
+  return 0;
+}
+
+int cmd_migrate(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1)
+    hashgen::instance->set_migrate(atoi(argv[1]));
+  printf("%d\n", hashgen::instance->get_migrate());
+  return 0;
+}
+
+int cmd_temp(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1 && hashgen::instance->set_temp(atof(argv[1]))) {
+    printf("temp must be a positive number\n");
+    return -1;
+  }
+  printf("%f\n", hashgen::instance->get_temp());
+  return 0;
+}
+
+int cmd_cooling(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1)
+    hashgen::instance->set_cooling(atof(argv[1]));
+  printf("%f\n", hashgen::instance->get_cooling());
+  return 0;
+}
+
+int cmd_swap(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1)
+    hashgen::instance->set_swap(atoi(argv[1]));
+  printf("%d\n", hashgen::instance->get_swap());
+  return 0;
+}
+
+int cmd_checkpoint(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1)
+    hashgen::instance->set_checkpoint(
+        argv[1], argc > 2 ? atoi(argv[2]) : CKPT_INTERVAL);
+  hashgen::instance->print_checkpoint();
+  return 0;
+}
+
+int cmd_resume(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc < 2 || hashgen::instance->resume(argv[1])) {
+    printf("cannot resume, give a complete, valid checkpoint file before "
+           "start\n");
+    return -1;
+  }
+  hashgen::instance->print_best_seen();
+  return 0;
+}
+
+int cmd_pareto(int argc, const char *argv[]) {
+  FILE *fp = stdout;
+
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1 && (fp = fopen(argv[1], "w")) == NULL) {
+    printf("cannot open %s\n", argv[1]);
+    return -1;
+  }
+  hashgen::instance->print_pareto(fp);
+  if (fp != stdout)
+    fclose(fp);
+  return 0;
+}
+
+int cmd_stats(int, const char **) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  hashgen::instance->print_stats();
+  return 0;
+}
+
+int cmd_cache(int argc, const char *argv[]) {
+  if (hashgen::instance == NULL) {
+    ULIB_FATAL("instance is NULL");
+    return -1;
+  }
+  if (argc > 1 && !strcmp(argv[1], "clear"))
+    hashgen::instance->clear_cache();
+  hashgen::instance->print_cache();
+  return 0;
+}
+
 int cmd_best_seen(int, const char **) {
   if (hashgen::instance == NULL) {
     ULIB_FATAL("instance is NULL");
@@ -920,29 +2704,22 @@ static uint64_t fasthash64_noseed(const void *buf, size_t len) {
   return fasthash64(buf, len, 0);
 }
 
-int cmd_standard(int, const char **) {
+// the reference functions get the same timing phase as candidates
+static void print_standard(const char *name, avalanche::hash_func_t h) {
   avalanche aval;
-  timespec timer;
-  float ascore, tscore;
-
-  timer_start(&timer);
-  ascore = aval(hash_jenkins_noseed, g_aval_len, g_aval_times);
-  tscore = timer_stop(&timer) * g_time_r;
-  printf("JenkinsHash: aval_score=%f, time_score=%f, overall=%f\n", ascore,
-         tscore, ascore + tscore);
-
-  timer_start(&timer);
-  ascore = aval(hash_xxhash_noseed, g_aval_len, g_aval_times);
-  tscore = timer_stop(&timer) * g_time_r;
-  printf("XXHash     : aval_score=%f, time_score=%f, overall=%f\n", ascore,
-         tscore, ascore + tscore);
+  float ascore, tscore, cycles, tput;
 
-  timer_start(&timer);
-  ascore = aval(fasthash64_noseed, g_aval_len, g_aval_times);
-  tscore = timer_stop(&timer) * g_time_r;
-  printf("fasthash64 : aval_score=%f, time_score=%f, overall=%f\n", ascore,
+  hashgen::time_hash(h, cycles, tput);
+  tscore = hashgen::time_score(cycles, tput);
+  ascore = aval(h, hashgen::aval_len(), g_aval_times);
+  printf("%s: aval_score=%f, time_score=%f, overall=%f\n", name, ascore,
          tscore, ascore + tscore);
+}
 
+int cmd_standard(int, const char **) {
+  print_standard("JenkinsHash", hash_jenkins_noseed);
+  print_standard("XXHash     ", hash_xxhash_noseed);
+  print_standard("fasthash64 ", fasthash64_noseed);
   return 0;
 }
 
@@ -957,11 +2734,33 @@ int cmd_help(int, const char **) {
          "max_seq      -- maximum sequence length\n"
          "aval_byte    -- buffer length for hash test\n"
          "aval_times   -- sample size\n"
+         "aval_conf    -- early abort margin in std devs, 0 disables\n"
+         "width        -- word size, 32 or 64; set before start\n"
+         "absorb       -- lanes of a block step to search instead of the\n"
+         "                finalizer, 1, 2 or 4; 0 searches the finalizer;\n"
+         "                set before start\n"
+         "workers      -- number of search threads, default: all cores\n"
+         "strategy     -- greedy, ga (islands), sa (annealing) or pt\n"
+         "                (parallel tempering); set before start\n"
+         "population   -- ga members per island\n"
+         "migrate      -- ga children between migrations\n"
+         "temp         -- sa starting and pt hottest temperature\n"
+         "cooling      -- sa temperature factor per candidate\n"
+         "swap         -- pt steps between replica swaps\n"
          "best_seen    -- print best seen result so far\n"
+         "checkpoint   -- 'checkpoint <file> [secs]' saves the search now and\n"
+         "                every secs (default 600) seconds\n"
+         "resume       -- 'resume <file>' continues a checkpoint on start\n"
+         "stats        -- print search progress\n"
+         "pareto       -- print the candidates no other one beats in\n"
+         "                aval score, bias and cycles; 'pareto <file>'\n"
+         "                saves them\n"
+         "cache        -- print fitness cache hits, 'cache clear' empties it\n"
          "\nFitness parameters:\n"
          "aval_rate    -- rate of avalanche score\n"
          "indep_rate   -- rate of independence test score\n"
-         "time_rate    -- rate of speed score\n");
+         "time_rate    -- speed score of 50 cycles per hash, or of one\n"
+         "                cycle per byte of a block step\n");
   return 0;
 }
 
@@ -972,9 +2771,50 @@ int main(int argc, const char *argv[]) {
   printf("Non-cryptographic Hash Function Generator 1.1 alpha\n");
   printf("Zilong Tan (eric.zltan@gmail.com)\n");
 
-  if (argc == 2 && !strcmp(argv[1], "start")) {
+  // hashgen -t secs ...: stop the search after secs seconds, print the
+  // result and exit, 0 if a function was scored. -w n and -a n set the
+  // workers and aval_times beforehand, for short runs on shared hosts.
+  int budget = 0;
+  while (argc > 2 && argv[1][0] == '-') {
+    if (!strcmp(argv[1], "-t")) {
+      budget = atoi(argv[2]);
+      if (budget <= 0) {
+        printf("-t needs a positive number of seconds\n");
+        return 1;
+      }
+    } else if (!strcmp(argv[1], "-w")) {
+      if (cmd_workers(2, argv + 1))
+        return 1;
+    } else if (!strcmp(argv[1], "-a")) {
+      if (cmd_aval_times(2, argv + 1))
+        return 1;
+    } else
+      break;
+    argv[2] = argv[0];
+    argv += 2;
+    argc -= 2;
+  }
+
+  if ((argc == 2 || argc == 3) && !strcmp(argv[1], "start")) {
+    // hashgen start 32: search for a 32-bit function
+    if (argc == 3 && cmd_width(argc - 1, argv + 1))
+      return 1;
     cmd_standard(argc, argv);
     cmd_start(argc, argv);
+    hashgen::instance->wait(budget);
+  } else if (argc == 3 && !strcmp(argv[1], "resume")) {
+    // hashgen resume file: continue a checkpoint, saving back to it
+    if (cmd_resume(argc - 1, argv + 1))
+      return 1;
+    cmd_start(argc, argv);
+    hashgen::instance->set_checkpoint(argv[2], CKPT_INTERVAL);
+    hashgen::instance->wait(budget);
+    // the threads are still there to save their state
+    if (hashgen::instance->checkpoint())
+      ULIB_WARNING("cannot write checkpoint %s", argv[2]);
+  } else if (budget) {
+    printf("-t needs start or resume\n");
+    return 1;
   } else {
     printf("Type \'help\' for a list of commands; \'exit\' to quit.\n");
     assert(console_init(&con) == 0);
@@ -984,9 +2824,24 @@ int main(int argc, const char *argv[]) {
     assert(console_bind(&con, "time_rate", cmd_time_rate) == 0);
     assert(console_bind(&con, "aval_byte", cmd_aval_byte) == 0);
     assert(console_bind(&con, "aval_times", cmd_aval_times) == 0);
+    assert(console_bind(&con, "aval_conf", cmd_aval_conf) == 0);
+    assert(console_bind(&con, "width", cmd_width) == 0);
+    assert(console_bind(&con, "absorb", cmd_absorb) == 0);
     assert(console_bind(&con, "min_seq", cmd_min_seq) == 0);
     assert(console_bind(&con, "max_seq", cmd_max_seq) == 0);
+    assert(console_bind(&con, "workers", cmd_workers) == 0);
+    assert(console_bind(&con, "strategy", cmd_strategy) == 0);
+    assert(console_bind(&con, "population", cmd_population) == 0);
+    assert(console_bind(&con, "migrate", cmd_migrate) == 0);
+    assert(console_bind(&con, "temp", cmd_temp) == 0);
+    assert(console_bind(&con, "cooling", cmd_cooling) == 0);
+    assert(console_bind(&con, "swap", cmd_swap) == 0);
     assert(console_bind(&con, "best_seen", cmd_best_seen) == 0);
+    assert(console_bind(&con, "checkpoint", cmd_checkpoint) == 0);
+    assert(console_bind(&con, "resume", cmd_resume) == 0);
+    assert(console_bind(&con, "stats", cmd_stats) == 0);
+    assert(console_bind(&con, "pareto", cmd_pareto) == 0);
+    assert(console_bind(&con, "cache", cmd_cache) == 0);
     assert(console_bind(&con, "std", cmd_standard) == 0);
     assert(console_bind(&con, "help", cmd_help) == 0);
     console_loop(&con, -1, "exit");
@@ -994,7 +2849,15 @@ int main(int argc, const char *argv[]) {
     printf("\nExiting Now ...\n\n");
   }
 
+  int ret = 0;
+  if (budget) {
+    hashgen::instance->print_stats();
+    hashgen::instance->stop();
+    hashgen::instance->print_best_seen();
+    ret = hashgen::instance->best_target() < HUGE_VALF ? 0 : 1;
+  }
+
   delete hashgen::instance;
 
-  return 0;
+  return ret;
 }
@@ -0,0 +1,157 @@
+/* The MIT License
+
+   Copyright (C) 2024 Reini Urban (reini.urban@gmail.com)
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without
+   restriction, including without limitation the rights to use, copy,
+   modify, merge, publish, distribute, sublicense, and/or sell copies
+   of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+// Short key microbenchmark: fasthash64 over random lengths 0..32,
+// compared with the original byte-wise switch tail.
+
+#include "../fasthash.h"
+#include <linux/perf_event.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ulib/hash.h>
+#include <ulib/rand_tpl.h>
+#include <ulib/rdtsc.h>
+
+#define NKEYS 4096
+#define ROUNDS 2000
+
+// fasthash64 as it was before the branch-light tail
+static uint64_t fasthash64_switch(const void *buf, size_t len, uint64_t seed) {
+  const uint64_t m = 0x880355f21e6d1965ULL;
+  const uint64_t *pos = (const uint64_t *)buf;
+  const uint64_t *end = pos + (len / 8);
+  const unsigned char *pos2;
+  uint64_t h = seed ^ (len * m);
+  uint64_t v;
+
+#define mix(h)                                                                 \
+  ({                                                                           \
+    (h) ^= (h) >> 23;                                                          \
+    (h) *= 0x2127599bf4325c37ULL;                                              \
+    (h) ^= (h) >> 47;                                                          \
+  })
+
+  while (pos != end) {
+    v = *pos++;
+    h ^= mix(v);
+    h *= m;
+  }
+
+  pos2 = (const unsigned char *)pos;
+  v = 0;
+
+  switch (len & 7) {
+  case 7:
+    v ^= (uint64_t)pos2[6] << 48; /* fallthrough */
+  case 6:
+    v ^= (uint64_t)pos2[5] << 40; /* fallthrough */
+  case 5:
+    v ^= (uint64_t)pos2[4] << 32; /* fallthrough */
+  case 4:
+    v ^= (uint64_t)pos2[3] << 24; /* fallthrough */
+  case 3:
+    v ^= (uint64_t)pos2[2] << 16; /* fallthrough */
+  case 2:
+    v ^= (uint64_t)pos2[1] << 8; /* fallthrough */
+  case 1:
+    v ^= (uint64_t)pos2[0];
+    h ^= mix(v);
+    h *= m;
+  }
+
+  return mix(h);
+#undef mix
+}
+
+// returns -1 where perf events are not permitted
+static int open_branch_misses() {
+  struct perf_event_attr attr;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static unsigned char g_buf[NKEYS + 64];
+static size_t g_off[NKEYS];
+static size_t g_len[NKEYS];
+
+static void run(const char *name,
+                uint64_t (*f)(const void *, size_t, uint64_t), int fd) {
+  uint64_t h = 0;
+  uint64_t misses = 0;
+  uint64_t start, cycles;
+
+  if (fd >= 0) {
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+  start = rdtsc();
+  for (int r = 0; r < ROUNDS; ++r)
+    for (int i = 0; i < NKEYS; ++i)
+      h += f(g_buf + g_off[i], g_len[i], r);
+  cycles = rdtsc() - start;
+  if (fd >= 0) {
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &misses, sizeof(misses)) != sizeof(misses))
+      misses = 0;
+  }
+
+  printf("%-18s %6.2f cycles/hash", name, (double)cycles / ROUNDS / NKEYS);
+  if (fd >= 0)
+    printf(", %6.4f branch misses/hash",
+           (double)misses / ROUNDS / NKEYS);
+  printf("  (%016llx)\n", (unsigned long long)h);
+}
+
+int main() {
+  uint64_t u, v, w;
+  int fd = open_branch_misses();
+
+  RAND_NR_INIT(u, v, w, 0x5eed);
+  for (size_t i = 0; i < sizeof(g_buf); ++i)
+    g_buf[i] = (unsigned char)RAND_NR_NEXT(u, v, w);
+  for (int i = 0; i < NKEYS; ++i) {
+    g_len[i] = RAND_NR_NEXT(u, v, w) % 33;
+    g_off[i] = RAND_NR_NEXT(u, v, w) % (sizeof(g_buf) - 32);
+  }
+
+  if (fd < 0)
+    printf("branch miss counter unavailable, timing only\n");
+  run("switch tail", fasthash64_switch, fd);
+  run("fasthash64", fasthash64, fd);
+  run("hash_fast64", hash_fast64, fd);
+
+  return 0;
+}
@@ -0,0 +1,520 @@
+/* The MIT License
+
+   Copyright (C) 2024 Reini Urban (reini.urban@gmail.com)
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without
+   restriction, including without limitation the rights to use, copy,
+   modify, merge, publish, distribute, sublicense, and/or sell copies
+   of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+// fasthash regression tests
+
+#include "../fasthash.h"
+#include "../fasthash.hpp"
+#include "tree_hash.h"
+#include <algorithm>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <ulib/alignhash_tpl.h>
+#include <ulib/hash.h>
+#include <ulib/rand_tpl.h>
+
+#define ARR_SIZE(x) sizeof(x) / sizeof(x[0])
+#define SEED 0x12345678
+
+static unsigned char g_buf[4096 + 8];
+
+static int g_failed = 0;
+
+#define CHECK_EQ(what, got, exp)                                               \
+  do {                                                                         \
+    if ((uint64_t)(got) != (uint64_t)(exp)) {                                  \
+      fprintf(stderr, "%s: expected %016" PRIx64 ", actual %016" PRIx64 "\n",  \
+              what, (uint64_t)(exp), (uint64_t)(got));                         \
+      ++g_failed;                                                              \
+    }                                                                          \
+  } while (0)
+
+// frozen output of fasthash64 over g_buf[i] = i * 7 + 3
+static const struct {
+  size_t len;
+  uint64_t hash;
+} fasthash64_vectors[] = {
+    {0, UINT64_C(0x4d17bccb463f07eb)},   {1, UINT64_C(0x9fde10e05d30c979)},
+    {3, UINT64_C(0x06b35ad81fd27ef4)},   {7, UINT64_C(0x8d3832676552cc89)},
+    {8, UINT64_C(0x4f19c219fb6444dc)},   {9, UINT64_C(0xc0127b2ea1360ec0)},
+    {15, UINT64_C(0x053b53a96a0f8e16)},  {16, UINT64_C(0x601606bdd1cca6d6)},
+    {31, UINT64_C(0xc5220cae7ab8dc92)},  {32, UINT64_C(0x89cb4843f7efd618)},
+    {33, UINT64_C(0x2db47c38fe0f0415)},  {63, UINT64_C(0x0ccff6cb1e3aa676)},
+    {64, UINT64_C(0x402a1c7c4eec1eed)},  {100, UINT64_C(0xb5d4f3bd49799de6)},
+    {255, UINT64_C(0xe72235195a3910e8)},
+};
+
+// frozen output of fasthash64_wide over the same buffer
+static const struct {
+  size_t len;
+  uint64_t hash;
+} fasthash64_wide_vectors[] = {
+    {0, UINT64_C(0x4d17bccb463f07eb)},    {7, UINT64_C(0x8d3832676552cc89)},
+    {31, UINT64_C(0xc5220cae7ab8dc92)},   {32, UINT64_C(0x175da3019519dc0b)},
+    {33, UINT64_C(0xdfba2d1f665039f0)},   {63, UINT64_C(0xe57dbda56e3ad06e)},
+    {64, UINT64_C(0xe1881d2073a893ac)},   {100, UINT64_C(0xe31bd875f5ef42ef)},
+    {255, UINT64_C(0x52cfed1013f51538)},  {1000, UINT64_C(0x555d01c02007dcf9)},
+    {4096, UINT64_C(0xd93302c22bed6db3)},
+};
+
+// frozen output of fasthash128 over the same buffer
+static const struct {
+  size_t len;
+  uint64_t hash[2];
+} fasthash128_vectors[] = {
+    {0, {UINT64_C(0x9a2f79968c7e0fd6), UINT64_C(0x6e3f16673a712585)}},
+    {1, {UINT64_C(0xbe3a672029807964), UINT64_C(0x2cead843edf857b7)}},
+    {7, {UINT64_C(0x027f4919356dc244), UINT64_C(0x34aed75d3112692c)}},
+    {8, {UINT64_C(0xed8da8078b54be9b), UINT64_C(0x491b99d2bc0f05f3)}},
+    {9, {UINT64_C(0x3d464337ef93f54e), UINT64_C(0xbf81800aa819c294)}},
+    {16, {UINT64_C(0x5a1f0a8c734434cd), UINT64_C(0x4b0d2c5cb71e4e19)}},
+    {33, {UINT64_C(0xcfe72bf4093210c3), UINT64_C(0x65cca2d0e2905608)}},
+    {64, {UINT64_C(0x5861378d49dd3a95), UINT64_C(0xe5ec11b42fbddba8)}},
+    {100, {UINT64_C(0x58595f55e17695ab), UINT64_C(0xb3bab0714dbe37b0)}},
+    {255, {UINT64_C(0x5ec983aa302c1315), UINT64_C(0x73d38df15074387d)}},
+    {1000, {UINT64_C(0x87cd76802153e976), UINT64_C(0x5c11fb16fdd3a130)}},
+};
+
+// frozen output of fasthash32_native over the same buffer
+static const struct {
+  size_t len;
+  uint32_t hash;
+} fasthash32_native_vectors[] = {
+    {0, 0x07808444},  {1, 0x3ceec1d4},   {2, 0xac39b1bc},  {3, 0x385e6612},
+    {4, 0x86a0d750},  {5, 0x638080fe},   {7, 0x9b2dd7c2},  {8, 0x13548511},
+    {15, 0x84aa2ff0}, {16, 0xada1c1c2},  {31, 0x073d6735}, {33, 0xa1b70e16},
+    {64, 0xa0c9ce86}, {100, 0x2f88ca16}, {255, 0x9b339348},
+};
+
+static void test_vectors() {
+  for (size_t i = 0; i < sizeof(g_buf); ++i)
+    g_buf[i] = (unsigned char)(i * 7 + 3);
+  for (size_t i = 0; i < ARR_SIZE(fasthash64_vectors); ++i)
+    CHECK_EQ("fasthash64 vector",
+             fasthash64(g_buf, fasthash64_vectors[i].len, SEED),
+             fasthash64_vectors[i].hash);
+  for (size_t i = 0; i < ARR_SIZE(fasthash64_wide_vectors); ++i)
+    CHECK_EQ("fasthash64_wide vector",
+             fasthash64_wide(g_buf, fasthash64_wide_vectors[i].len, SEED),
+             fasthash64_wide_vectors[i].hash);
+  for (size_t i = 0; i < ARR_SIZE(fasthash32_native_vectors); ++i)
+    CHECK_EQ("fasthash32_native vector",
+             fasthash32_native(g_buf, fasthash32_native_vectors[i].len, SEED),
+             fasthash32_native_vectors[i].hash);
+  for (size_t i = 0; i < ARR_SIZE(fasthash128_vectors); ++i) {
+    uint64_t h[2];
+    fasthash128(g_buf, fasthash128_vectors[i].len, SEED, h);
+    CHECK_EQ("fasthash128 vector", h[0], fasthash128_vectors[i].hash[0]);
+    CHECK_EQ("fasthash128 vector", h[1], fasthash128_vectors[i].hash[1]);
+  }
+}
+
+static void rand_fill(uint64_t &u, uint64_t &v, uint64_t &w) {
+  for (size_t i = 0; i < sizeof(g_buf); ++i)
+    g_buf[i] = (unsigned char)RAND_NR_NEXT(u, v, w);
+}
+
+static void test_stream(uint64_t &u, uint64_t &v, uint64_t &w) {
+  struct fasthash64_state st;
+
+  for (size_t len = 0; len < 300; ++len) {
+    uint64_t ref = fasthash64(g_buf, len, SEED);
+    // feed in random fragments, including empty ones
+    for (int k = 0; k < 8; ++k) {
+      size_t off = 0;
+      fasthash64_init(&st, len, SEED);
+      while (off < len) {
+        size_t n = RAND_NR_NEXT(u, v, w) % 20;
+        if (n > len - off)
+          n = len - off;
+        fasthash64_update(&st, g_buf + off, n);
+        off += n;
+      }
+      CHECK_EQ("fasthash64_update", fasthash64_final(&st), ref);
+    }
+  }
+}
+
+static void test_iov(uint64_t &u, uint64_t &v, uint64_t &w) {
+  struct iovec iov[16];
+
+  for (int round = 0; round < 2000; ++round) {
+    int cnt = RAND_NR_NEXT(u, v, w) % ARR_SIZE(iov);
+    size_t off = RAND_NR_NEXT(u, v, w) % 8;
+    size_t len = off;
+    for (int i = 0; i < cnt; ++i) {
+      iov[i].iov_base = g_buf + len;
+      iov[i].iov_len = RAND_NR_NEXT(u, v, w) % 24;
+      len += iov[i].iov_len;
+    }
+    CHECK_EQ("fasthash64_iov", fasthash64_iov(iov, cnt, SEED),
+             fasthash64(g_buf + off, len - off, SEED));
+  }
+}
+
+static void test_tree(uint64_t &u, uint64_t &v, uint64_t &w) {
+  size_t len = 3 * FASTHASH_TREE_CHUNK + 12345;
+  unsigned char *buf = (unsigned char *)malloc(len);
+  uint64_t d[4];
+
+  for (size_t i = 0; i < len; ++i)
+    buf[i] = (unsigned char)RAND_NR_NEXT(u, v, w);
+  for (int i = 0; i < 4; ++i)
+    d[i] = fasthash64_wide(buf + i * FASTHASH_TREE_CHUNK,
+                           i < 3 ? FASTHASH_TREE_CHUNK : 12345, SEED);
+
+  CHECK_EQ("fasthash64_tree", fasthash64_tree(buf, len, SEED),
+           fasthash64(d, sizeof(d), SEED));
+  CHECK_EQ("fasthash64_tree empty", fasthash64_tree(NULL, 0, SEED),
+           fasthash64(NULL, 0, SEED));
+  for (int t = 1; t <= 5; ++t) {
+    CHECK_EQ("tree_hash", tree_hash(buf, len, SEED, t),
+             fasthash64_tree(buf, len, SEED));
+    CHECK_EQ("tree_hash", tree_hash(buf, 100, SEED, t),
+             fasthash64_tree(buf, 100, SEED));
+  }
+  free(buf);
+}
+
+static void test_batch(uint64_t &u, uint64_t &v, uint64_t &w) {
+  const void *bufs[67];
+  size_t lens[67];
+  uint64_t out[67];
+
+  for (int round = 0; round < 100; ++round) {
+    size_t n = RAND_NR_NEXT(u, v, w) % ARR_SIZE(bufs);
+    for (size_t i = 0; i < n; ++i) {
+      lens[i] = RAND_NR_NEXT(u, v, w) % 80;
+      bufs[i] = g_buf + RAND_NR_NEXT(u, v, w) % (sizeof(g_buf) - 80);
+    }
+    fasthash64_batch(bufs, lens, n, SEED, out);
+    for (size_t i = 0; i < n; ++i)
+      CHECK_EQ("fasthash64_batch", out[i], fasthash64(bufs[i], lens[i], SEED));
+  }
+}
+
+static void test_strided(uint64_t &u, uint64_t &v, uint64_t &w) {
+  uint64_t out[67];
+
+  for (size_t width = 0; width <= 40; ++width) {
+    for (int round = 0; round < 10; ++round) {
+      size_t stride = width + RAND_NR_NEXT(u, v, w) % 16;
+      size_t n = RAND_NR_NEXT(u, v, w) % ARR_SIZE(out);
+      if (stride * n > sizeof(g_buf))
+        n = sizeof(g_buf) / (stride ? stride : 1);
+      fasthash64_strided(g_buf, width, stride, n, SEED, out);
+      for (size_t i = 0; i < n; ++i)
+        CHECK_EQ("fasthash64_strided", out[i],
+                 fasthash64(g_buf + i * stride, width, SEED));
+    }
+  }
+}
+
+using namespace fasthash::literals;
+
+static void test_constexpr() {
+  constexpr uint64_t h = "fasthash"_fh;
+  constexpr uint32_t h32 = fasthash::fasthash32("fasthash", 7);
+  static_assert(h == fasthash::fasthash64("fasthash"), "literal");
+
+  CHECK_EQ("_fh", h, fasthash64("fasthash", 8, 0));
+  switch (fasthash64("hash", 4, 0)) {
+  case "fast"_fh:
+    CHECK_EQ("_fh switch", 0, 1);
+    break;
+  case "hash"_fh:
+    break;
+  default:
+    CHECK_EQ("_fh switch", 0, 2);
+  }
+  CHECK_EQ("constexpr fasthash32", h32, fasthash32("fasthash", 8, 7));
+  // the header reads the tail byte by byte, a reference for the
+  // overlapping loads of fasthash.c at every buffer offset
+  for (size_t off = 0; off < 8; ++off) {
+    for (size_t len = 0; len < 300; ++len) {
+      const unsigned char *p = g_buf + off;
+      CHECK_EQ("constexpr fasthash64", fasthash::fasthash64(p, len, SEED),
+               fasthash64(p, len, SEED));
+      CHECK_EQ("constexpr fasthash32", fasthash::fasthash32(p, len, SEED),
+               fasthash32(p, len, SEED));
+    }
+  }
+}
+
+static void test_fixed(uint64_t &u, uint64_t &v, uint64_t &w) {
+  struct pair64 {
+    uint64_t a, b;
+  };
+  struct bytes3 {
+    unsigned char c[3];
+  };
+
+  for (int i = 0; i < 10000; ++i) {
+    uint64_t k64 = RAND_NR_NEXT(u, v, w);
+    uint64_t seed = RAND_NR_NEXT(u, v, w);
+    uint32_t k32 = (uint32_t)k64;
+    int32_t i32 = (int32_t)k64;
+    pair64 p = {k64, seed ^ k64};
+    bytes3 b = {{(unsigned char)k64, (unsigned char)seed, 7}};
+
+    CHECK_EQ("fasthash64_u32", fasthash64_u32(k32, seed),
+             fasthash64(&k32, sizeof(k32), seed));
+    CHECK_EQ("fasthash64_u64", fasthash64_u64(k64, seed),
+             fasthash64(&k64, sizeof(k64), seed));
+    CHECK_EQ("fasthash64_u128", fasthash64_u128(p.a, p.b, seed),
+             fasthash64(&p, sizeof(p), seed));
+    CHECK_EQ("fasthash64_key<int32_t>", fasthash64_key(i32, seed),
+             fasthash64(&i32, sizeof(i32), seed));
+    CHECK_EQ("fasthash64_key<uint64_t>", fasthash64_key(k64, seed),
+             fasthash64(&k64, sizeof(k64), seed));
+    CHECK_EQ("fasthash64_key<pair64>", fasthash64_key(p, seed),
+             fasthash64(&p, sizeof(p), seed));
+    CHECK_EQ("fasthash64_key<bytes3>", fasthash64_key(b, seed),
+             fasthash64(&b, sizeof(b), seed));
+  }
+}
+
+// ulib's hash_fast64 must stay identical to fasthash64, inline or not
+static void test_ulib() {
+  uint64_t (*out_of_line)(const void *, size_t, uint64_t) = hash_fast64;
+
+  for (size_t off = 0; off < 8; ++off) {
+    const unsigned char *p = g_buf + off;
+    for (size_t len = 0; len < 300; ++len)
+      CHECK_EQ("hash_fast64", hash_fast64(p, len, SEED),
+               fasthash64(p, len, SEED));
+    CHECK_EQ("hash_fast64(4)", hash_fast64(p, 4, SEED),
+             fasthash64(p, 4, SEED));
+    CHECK_EQ("hash_fast64(8)", hash_fast64(p, 8, SEED),
+             fasthash64(p, 8, SEED));
+    CHECK_EQ("hash_fast64(16)", hash_fast64(p, 16, SEED),
+             fasthash64(p, 16, SEED));
+    CHECK_EQ("hash_fast64 symbol", out_of_line(p, 100, SEED),
+             fasthash64(p, 100, SEED));
+  }
+}
+
+// largest number of keys that share one of 4096 buckets
+static int max_load(const uint64_t *h, int n) {
+  static int load[4096];
+  int max = 0;
+
+  memset(load, 0, sizeof(load));
+  for (int i = 0; i < n; ++i) {
+    int b = h[i] & 4095;
+    if (++load[b] > max)
+      max = load[b];
+  }
+  return max;
+}
+
+// "test_fasthash secret-load": the largest bucket load of
+// fasthash64_secret over the keys on stdin, under this process's secret
+static int secret_load_main() {
+  uint64_t h[256];
+  unsigned long long k;
+  int n = 0;
+
+  while (n < 256 && scanf("%llx", &k) == 1) {
+    uint64_t key = k;
+    h[n++] = fasthash64_secret(&key, sizeof(key), SEED);
+  }
+  printf("%d\n", max_load(h, n));
+  return 0;
+}
+
+// largest bucket load of the keys in a fresh process, whose secret is
+// drawn anew; -1 if the process cannot be run
+static int secret_load_elsewhere(const uint64_t *keys, int n) {
+  char exe[4096], path[] = "/tmp/test_fasthash.XXXXXX", cmd[8300];
+  ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+  int fd = mkstemp(path), load = -1;
+  FILE *fp;
+
+  if (len <= 0 || fd < 0) {
+    if (fd >= 0) {
+      close(fd);
+      unlink(path);
+    }
+    return -1;
+  }
+  exe[len] = 0;
+  fp = fdopen(fd, "w");
+  for (int i = 0; i < n; ++i)
+    fprintf(fp, "%llx\n", (unsigned long long)keys[i]);
+  fclose(fp);
+  snprintf(cmd, sizeof(cmd), "'%s' secret-load < %s", exe, path);
+  if ((fp = popen(cmd, "r")) != NULL) {
+    if (fscanf(fp, "%d", &load) != 1)
+      load = -1;
+    pclose(fp);
+  }
+  unlink(path);
+  return load;
+}
+
+// inverse of fasthash's mix()
+static uint64_t unmix(uint64_t h) {
+  uint64_t inv = 0x2127599bf4325c37ULL;
+
+  // Newton's iteration for the inverse of an odd number mod 2^64
+  for (int i = 0; i < 5; ++i)
+    inv *= 2 - 0x2127599bf4325c37ULL * inv;
+  h ^= h >> 47;
+  h *= inv;
+  return h ^ (h >> 23) ^ (h >> 46);
+}
+
+// Keys of 16 words. Word pair j is either (a, b) or the pair whose mixed
+// values differ from mix(a), mix(b) in bit 63 only: the first flip
+// survives the chain multiply as a flip of bit 63, which the second one
+// cancels. Whatever the seed, all 256 keys thus share one fasthash64
+// chain state, unless the words are keyed before they are mixed.
+static void msb_flood(uint64_t (*keys)[16], int n) {
+  const uint64_t msb = 1ULL << 63;
+  uint64_t a = 0x0123456789abcdefULL, b = 0xfedcba9876543210ULL;
+
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < 8; ++j) {
+      uint64_t x = a + j, y = b - j;
+      if (i >> j & 1) {
+        x = unmix(fasthash_mix(x) ^ msb);
+        y = unmix(fasthash_mix(y) ^ msb);
+      }
+      keys[i][2 * j] = x;
+      keys[i][2 * j + 1] = y;
+    }
+  }
+}
+
+static void test_secret() {
+  const int n = 256;
+  uint64_t keys[n], h[n];
+  int i = 0;
+
+  CHECK_EQ("fasthash64_secret stable", fasthash64_secret(g_buf, 100, SEED),
+           fasthash64_secret(g_buf, 100, SEED));
+  if (fasthash64_secret(g_buf, 100, SEED) == fasthash64(g_buf, 100, SEED) ||
+      fasthash64_secret(g_buf, 100, SEED) == fasthash64_secret(g_buf, 100, 0))
+    CHECK_EQ("fasthash64_secret keyed", 0, 1);
+
+  // a flood precomputed against fasthash64: all keys share bucket 0
+  for (uint64_t k = 0; i < n; ++k)
+    if ((fasthash64(&k, sizeof(k), SEED) & 4095) == 0)
+      keys[i++] = k;
+  for (i = 0; i < n; ++i)
+    h[i] = fasthash64(&keys[i], sizeof(keys[i]), SEED);
+  CHECK_EQ("fasthash64 flood", max_load(h, n), n);
+  for (i = 0; i < n; ++i)
+    h[i] = fasthash64_secret(&keys[i], sizeof(keys[i]), SEED);
+  if (max_load(h, n) >= 8)
+    CHECK_EQ("fasthash64_secret flood", max_load(h, n), 0);
+
+  // a flood through the chain, not the buckets: every key collides in
+  // all 64 bits without the per-word key
+  {
+    static uint64_t fkeys[n][16];
+    msb_flood(fkeys, n);
+    for (i = 0; i < n; ++i)
+      h[i] = fasthash64(fkeys[i], sizeof(fkeys[i]), SEED);
+    int same = 0;
+    for (i = 1; i < n; ++i)
+      same += h[i] == h[0];
+    CHECK_EQ("fasthash64 msb flood", same, n - 1);
+    for (i = 0; i < n; ++i)
+      h[i] = fasthash64_secret(fkeys[i], sizeof(fkeys[i]), SEED);
+    std::sort(h, h + n);
+    CHECK_EQ("fasthash64_secret msb flood", std::unique(h, h + n) - h, n);
+  }
+
+  // The real attack: a flood built against the secret of this process
+  // fills one bucket here, but another process draws another secret,
+  // and there the same keys spread like random ones.
+  i = 0;
+  for (uint64_t k = 0; i < n; ++k)
+    if ((fasthash64_secret(&k, sizeof(k), SEED) & 4095) == 0)
+      keys[i++] = k;
+  for (i = 0; i < n; ++i)
+    h[i] = fasthash64_secret(&keys[i], sizeof(keys[i]), SEED);
+  CHECK_EQ("fasthash64_secret flood, same secret", max_load(h, n), n);
+  int load = secret_load_elsewhere(keys, n);
+  if (load < 0)
+    fprintf(stderr, "fasthash64_secret flood: cannot run %s, skipped\n",
+            "a second process");
+  else if (load >= 8)
+    CHECK_EQ("fasthash64_secret flood, fresh secret", load, 0);
+
+  // the same for the ulib aligned hash tables and their naive hash
+  for (i = 0; i < n; ++i) {
+    uint64_t k = (uint64_t)i << 20;
+    h[i] = alignhash_hashfn(k);
+  }
+  CHECK_EQ("alignhash_hashfn flood", max_load(h, n), n);
+  for (i = 0; i < n; ++i) {
+    uint64_t k = (uint64_t)i << 20;
+    h[i] = alignhash_secretfn(k);
+  }
+  if (max_load(h, n) >= 8)
+    CHECK_EQ("alignhash_secretfn flood", max_load(h, n), 0);
+}
+
+static const char *kernels[] = {"scalar", "avx2", "avx512"};
+
+int main(int argc, char *argv[]) {
+  uint64_t u, v, w;
+
+  if (argc == 2 && !strcmp(argv[1], "secret-load"))
+    return secret_load_main();
+
+  RAND_NR_INIT(u, v, w, 0x5eed);
+
+  test_vectors();
+  rand_fill(u, v, w);
+  test_stream(u, v, w);
+  test_iov(u, v, w);
+  test_tree(u, v, w);
+  test_constexpr();
+  test_fixed(u, v, w);
+  test_ulib();
+  test_secret();
+  for (size_t i = 0; i < ARR_SIZE(kernels); ++i) {
+    if (fasthash_select_kernel(kernels[i]))
+      continue;
+    test_batch(u, v, w);
+    test_strided(u, v, w);
+  }
+
+  if (g_failed) {
+    fprintf(stderr, "%d checks failed\n", g_failed);
+    return EXIT_FAILURE;
+  }
+  printf("passed\n");
+
+  return 0;
+}
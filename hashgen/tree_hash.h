@@ -0,0 +1,91 @@
+/* The MIT License
+
+   Copyright (C) 2024 Reini Urban (reini.urban@gmail.com)
+
+   Permission is hereby granted, free of charge, to any person
+   obtaining a copy of this software and associated documentation
+   files (the "Software"), to deal in the Software without
+   restriction, including without limitation the rights to use, copy,
+   modify, merge, publish, distribute, sublicense, and/or sell copies
+   of the Software, and to permit persons to whom the Software is
+   furnished to do so, subject to the following conditions:
+
+   The above copyright notice and this permission notice shall be
+   included in all copies or substantial portions of the Software.
+
+   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+   EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+   MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+   BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+   SOFTWARE.
+*/
+
+// Parallel fasthash64_tree() on ulib::thread workers.
+
+#ifndef _TREE_HASH_H
+#define _TREE_HASH_H
+
+#include "../fasthash.h"
+#include <stdint.h>
+#include <vector>
+#include <ulib/thread.h>
+
+// digests a contiguous range of chunks, so each worker reads its part
+// of the input sequentially
+class tree_worker : public ulib::thread {
+public:
+  tree_worker(const unsigned char *buf, size_t len, size_t first,
+              size_t last, uint64_t seed, uint64_t *digests)
+      : _buf(buf), _len(len), _first(first), _last(last), _seed(seed),
+        _digests(digests) {}
+
+  ~tree_worker() { join(); }
+
+  int run() {
+    for (size_t i = _first; i < _last; ++i) {
+      size_t off = i * FASTHASH_TREE_CHUNK;
+      size_t clen = _len - off;
+      if (clen > FASTHASH_TREE_CHUNK)
+        clen = FASTHASH_TREE_CHUNK;
+      _digests[i] = fasthash64_wide(_buf + off, clen, _seed);
+    }
+    return 0;
+  }
+
+private:
+  const unsigned char *_buf;
+  size_t _len;
+  size_t _first;
+  size_t _last;
+  uint64_t _seed;
+  uint64_t *_digests;
+};
+
+// same value as fasthash64_tree(buf, len, seed), nthreads >= 1
+static inline uint64_t tree_hash(const void *buf, size_t len, uint64_t seed,
+                                 int nthreads) {
+  size_t n = (len + FASTHASH_TREE_CHUNK - 1) / FASTHASH_TREE_CHUNK;
+  std::vector<uint64_t> digests(n);
+  std::vector<tree_worker *> workers;
+
+  if ((size_t)nthreads > n)
+    nthreads = n ? n : 1;
+  for (int t = 0; t < nthreads; ++t) {
+    tree_worker *w = new tree_worker(
+        (const unsigned char *)buf, len, n * t / nthreads,
+        n * (t + 1) / nthreads, seed, digests.data());
+    // the calling thread takes the last range itself
+    if (t == nthreads - 1 || w->start())
+      w->run();
+    workers.push_back(w);
+  }
+  for (size_t t = 0; t < workers.size(); ++t)
+    delete workers[t];
+
+  return fasthash64_tree_root(digests.data(), n, seed);
+}
+
+#endif